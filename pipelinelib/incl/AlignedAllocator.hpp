@@ -0,0 +1,57 @@
+#pragma once
+
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace mfep {
+namespace Pipeline {
+
+// Allocator placing the first item on an alignment boundary, so vector loads never straddle a cache
+// line at the start of a buffer. The original allocation is stored right before the aligned one.
+template<typename T, size_t Alignment = 64>
+class AlignedAllocator {
+    static_assert(Alignment >= alignof(void*) && (Alignment & (Alignment - 1)) == 0,
+                  "The alignment has to be a power of two holding a pointer");
+
+public:
+    using value_type = T;
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+    {
+    }
+    T* allocate(size_t count) {
+        if (count > (static_cast<size_t>(-1) - Alignment - sizeof(void*)) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        void* raw = ::operator new(count * sizeof(T) + Alignment + sizeof(void*));
+        const auto aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + Alignment - 1) & ~(uintptr_t(Alignment) - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    }
+    void deallocate(T* data, size_t) {
+        ::operator delete(reinterpret_cast<void**>(data)[-1]);
+    }
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const {
+        return false;
+    }
+};
+
+// Items of one field stored next to each other, the layout vectorized kernels work on.
+template<typename T>
+using Column = std::vector<T, AlignedAllocator<T>>;
+
+}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace mfep {
+namespace Pipeline {
+
+// Monotonic allocator: memory is carved sequentially out of large blocks and is only
+// given back all at once, when the arena is destroyed.
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment);
+
+private:
+    std::vector<std::unique_ptr<unsigned char[]>> m_blocks;
+    const size_t                                  m_blockSize;
+    unsigned char*                                m_current;
+    size_t                                        m_remaining;
+};
+
+}
+}
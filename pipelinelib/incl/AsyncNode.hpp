@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <functional>
+#include "NodeStructure.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Node waiting for I/O or another service instead of computing: processAsync() only starts the work,
+// and the outputs are published once it reports back through the completion. Parallel and asynchronous
+// executions don't tie up a worker while it waits, the serial execute() blocks until it's done.
+template<typename InTup, typename OutTup>
+class AsyncNode : public Node<InTup, OutTup> {
+    using NodeClass = Node<InTup, OutTup>;
+
+public:
+    using InData  = typename NodeClass::InData;
+    using OutData = typename NodeClass::OutData;
+
+    // Reports the result of a processAsync() call, from any thread. Copies share the report: only
+    // the first one counts, later ones are ignored, as is an exception thrown by processAsync() after it.
+    class Completion {
+    public:
+        using Handler = std::function<void(OutData* outData, std::exception_ptr error)>;
+
+        explicit Completion(Handler handler) :
+            m_handler(std::move(handler)),
+            m_reported(std::make_shared<std::atomic<bool>>(false))
+        {
+        }
+        void complete(OutData outData) const {
+            if (!m_reported->exchange(true)) {
+                m_handler(&outData, nullptr);
+            }
+        }
+        void fail(std::exception_ptr error) const {
+            if (!m_reported->exchange(true)) {
+                m_handler(nullptr, std::move(error));
+            }
+        }
+
+    private:
+        Handler                            m_handler;
+        std::shared_ptr<std::atomic<bool>> m_reported;
+    };
+
+    // The values the inputs refer to stay valid until the completion is called, but inData itself
+    // only lives during the call: work deferred past it has to copy the tuple or the references.
+    virtual void processAsync(const InData& inData, Completion completion) const = 0;
+
+    OutData process(const InData& inData) const final {
+        auto result = std::make_shared<std::promise<OutData>>();
+        auto future = result->get_future();
+        const Completion completion([result](OutData* outData, std::exception_ptr error){
+            if (outData != nullptr) {
+                result->set_value(std::move(*outData));
+            } else {
+                result->set_exception(error);
+            }
+        });
+        try {
+            processAsync(inData, completion);
+        } catch (...) {
+            completion.fail(std::current_exception());
+        }
+        return future.get();
+    }
+    bool isAsynchronous() const override {
+        return true;
+    }
+    void evaluateAsync(NodeBase::EvaluationCallback done) override {
+        NodeProfile* const profile = NodeClass::getProfile();
+        const auto start = NodeProfile::Clock::now();
+        if (profile != nullptr) {
+            ++profile->evaluations;
+        }
+        const Completion completion([this, profile, start, done](OutData* outData, std::exception_ptr error){
+            if (outData != nullptr) {
+                if (profile != nullptr) {
+                    profile->processTime += NodeProfile::Clock::now() - start;
+                }
+                try {
+                    NodeClass::finishEvaluation(*outData, profile);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            finish(profile, start, done, error);
+        });
+        try {
+            if (!NodeClass::beginEvaluation(profile)) {
+                finish(profile, start, done, nullptr);
+                return;
+            }
+            processAsync(NodeClass::getInputData(), completion);
+        } catch (...) {
+            // done runs once, not again when the node already reported
+            completion.fail(std::current_exception());
+        }
+    }
+
+private:
+    static void finish(NodeProfile* profile, NodeProfile::Clock::time_point start,
+                       const NodeBase::EvaluationCallback& done, std::exception_ptr error) {
+        if (profile != nullptr) {
+            profile->wallTime += NodeProfile::Clock::now() - start;
+        }
+        done(error);
+    }
+};
+
+}
+}
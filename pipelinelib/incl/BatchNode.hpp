@@ -0,0 +1,150 @@
+#pragma once
+
+#include "NodeStructure.hpp"
+#include "AlignedAllocator.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Contiguous items of one input or output of a batch.
+template<typename T>
+class Span {
+public:
+    Span(T* data, size_t size) :
+        m_data(data),
+        m_size(size)
+    {
+    }
+    T* data() const {
+        return m_data;
+    }
+    size_t size() const {
+        return m_size;
+    }
+    T& operator[](size_t index) const {
+        return m_data[index];
+    }
+    T* begin() const {
+        return m_data;
+    }
+    T* end() const {
+        return m_data + m_size;
+    }
+
+private:
+    T*     m_data;
+    size_t m_size;
+};
+
+// Node working on many items per call, for cheap per-item work where calling process() for every
+// item would cost more than the work itself. In a stream the stage takes whatever items are already
+// queued, up to the batch size, and hands them over as columns: the input items are copied into
+// aligned columns, and the outputs of a batch share one aligned allocation. A single-value evaluation is a batch
+// of one, without any copy. getInputHandle() isn't meant for processBatch().
+template<typename InTup, typename OutTup>
+class BatchNode {
+};
+template<typename ... InTs, typename ... OutTs>
+class BatchNode<tuple<InTs...>, tuple<OutTs...>> : public Node<tuple<InTs...>, tuple<OutTs...>> {
+    using NodeClass = Node<tuple<InTs...>, tuple<OutTs...>>;
+
+public:
+    using InData   = typename NodeClass::InData;
+    using OutData  = typename NodeClass::OutData;
+    using InBatch  = tuple<Span<const InTs>...>;
+    using OutBatch = tuple<Span<OutTs>...>;
+
+    static constexpr size_t DefaultBatchSize = 256;
+
+    // Fills the i-th item of every output from the i-th item of every input, all spans have the same size.
+    virtual void processBatch(const InBatch& inBatch, const OutBatch& outBatch) const = 0;
+
+    OutData process(const InData& inData) const final {
+        return processSingle(inData, std::index_sequence_for<InTs...>{}, std::index_sequence_for<OutTs...>{});
+    }
+    unique_ptr<StreamStage> createStreamStage(size_t queueCapacity) override {
+        return std::make_unique<Stream>(*this, queueCapacity);
+    }
+    // Items a stream hands over at most in one call, applies to streams started afterwards.
+    void setBatchSize(size_t batchSize) {
+        if (batchSize == 0) {
+            throw PIPELINE_EXCEPTION("Batches need at least one item");
+        }
+        m_batchSize = batchSize;
+    }
+    size_t getBatchSize() const {
+        return m_batchSize;
+    }
+
+private:
+    template<size_t ... InIndices, size_t ... OutIndices>
+    OutData processSingle(const InData& inData, std::index_sequence<InIndices...>, std::index_sequence<OutIndices...>) const {
+        tuple<unique_ptr<OutTs>...> buffers{ NodeClass::template acquireOutputBuffer<OutIndices>()... };
+        processBatch(InBatch{ Span<const InTs>(&std::get<InIndices>(inData), 1)... },
+                     OutBatch{ Span<OutTs>(std::get<OutIndices>(buffers).get(), 1)... });
+        return OutData{ DataPtr<OutTs>(std::move(std::get<OutIndices>(buffers)))... };
+    }
+
+    class Stream : public NodeClass::Stream {
+        using Items = typename StreamInputs<tuple<InTs...>>::Items;
+
+    public:
+        Stream(BatchNode& node, size_t capacity) :
+            NodeClass::Stream(node, capacity),
+            m_batchNode(node),
+            m_batchSize(node.m_batchSize)
+        {
+        }
+        bool step() override {
+            if (sizeof...(InTs) == 0) {
+                throw PIPELINE_EXCEPTION("Only stream sources can start a stream");
+            }
+            Items items;
+            if (!this->m_inputs.pop(items)) {
+                return false;
+            }
+            clearColumns(std::index_sequence_for<InTs...>{});
+            size_t count = 0;
+            do {
+                append(items, std::index_sequence_for<InTs...>{});
+                ++count;
+            } while (count < m_batchSize && this->m_inputs.tryPop(items));
+            processColumns(count, std::index_sequence_for<InTs...>{}, std::index_sequence_for<OutTs...>{});
+            return true;
+        }
+
+    private:
+        template<size_t ... Indices>
+        void clearColumns(std::index_sequence<Indices...>) {
+            using swallow = int[];
+            (void)swallow{ 0, (std::get<Indices>(m_columns).clear(), 1)... };
+        }
+        template<size_t ... Indices>
+        void append(const Items& items, std::index_sequence<Indices...>) {
+            using swallow = int[];
+            (void)swallow{ 0, (std::get<Indices>(m_columns).push_back(*std::get<Indices>(items)), 1)... };
+        }
+        template<size_t ... InIndices, size_t ... OutIndices>
+        void processColumns(size_t count, std::index_sequence<InIndices...>, std::index_sequence<OutIndices...>) {
+            tuple<shared_ptr<Column<OutTs>>...> outColumns{ std::make_shared<Column<OutTs>>(count)... };
+            m_batchNode.processBatch(InBatch{ Span<const InTs>(std::get<InIndices>(m_columns).data(), count)... },
+                                     OutBatch{ Span<OutTs>(std::get<OutIndices>(outColumns)->data(), count)... });
+            for (size_t i = 0; i < count; ++i) {
+                // every item keeps the whole column alive instead of being allocated on its own
+                using swallow = int[];
+                (void)swallow{ 0, (this->m_outputs.template push<OutIndices>(shared_ptr<const OutTs>(
+                    std::get<OutIndices>(outColumns), std::get<OutIndices>(outColumns)->data() + i)), 1)... };
+            }
+        }
+
+        const BatchNode&       m_batchNode;
+        const size_t           m_batchSize;
+        // the input items of the current batch, next to each other
+        tuple<Column<InTs>...> m_columns;
+    };
+
+    size_t m_batchSize = DefaultBatchSize;
+};
+
+}
+}
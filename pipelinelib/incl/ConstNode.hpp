@@ -5,27 +5,30 @@
 namespace mfep {
 namespace Pipeline {
 
+// Publishes its value as a shared handle, so evaluation never copies the data.
 template<typename T>
 class ConstNode : public Node<tuple<>, tuple<T>> {
 public:
-    ConstNode() : m_data()
+    using OutData = typename Node<tuple<>, tuple<T>>::OutData;
+
+    ConstNode() : m_data(std::make_shared<const T>())
     {
     }
-    explicit ConstNode(T&& data) : m_data(data)
+    explicit ConstNode(T&& data) : m_data(std::make_shared<const T>(std::move(data)))
     {
     }
-    tuple<unique_ptr<T>> process(const tuple<>& inData) const override {
-        return tuple<unique_ptr<T>>{ std::make_unique<T>(m_data) };
+    OutData process(const tuple<>& inData) const override {
+        return OutData{ m_data };
     }
     const T& getData() const {
-        return m_data;
+        return *m_data;
     }
     void setData(const T& data) {
-        m_data = data;
+        m_data = std::make_shared<const T>(data);
     }
 
 private:
-    T m_data;
+    shared_ptr<const T> m_data;
 };
 
 }
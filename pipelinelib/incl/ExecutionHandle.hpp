@@ -0,0 +1,60 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace mfep {
+namespace Pipeline {
+
+// Handle to an execution running in the background, returned by NodeExecution::executeAsync.
+// Copies refer to the same execution.
+class ExecutionHandle {
+public:
+    enum class Status {
+        Running,
+        Completed,
+        Failed,
+        Cancelled
+    };
+    using Callback = std::function<void(Status)>;
+
+    Status getStatus () const;
+    bool   isDone    () const;
+    void   wait      () const;
+    // Waits for the execution, then rethrows the exception of a failed one and throws
+    // if it got cancelled.
+    void   get       () const;
+    // Nodes that haven't started yet are skipped and stay invalid, the running ones finish.
+    void   cancel    ();
+    // Called once the execution is done, on the thread that finished it, or immediately on
+    // the calling thread if it's done already. The execution counts as done before its callbacks
+    // run: they can wait for it and start the next execution, and waiting for it doesn't wait
+    // for them. Callbacks must not throw.
+    void   onComplete(Callback callback);
+
+private:
+    friend class NodeExecution;
+
+    struct State {
+        mutable std::mutex              mutex;
+        mutable std::condition_variable done;
+        Status                          status = Status::Running;
+        std::exception_ptr              error;
+        std::vector<Callback>           callbacks;
+        std::atomic<bool>               cancelRequested { false };
+
+        void complete(Status result, std::exception_ptr exception);
+    };
+
+    explicit ExecutionHandle(std::shared_ptr<State> state);
+
+    std::shared_ptr<State> m_state;
+};
+
+}
+}
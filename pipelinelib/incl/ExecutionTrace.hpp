@@ -0,0 +1,63 @@
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+
+namespace mfep {
+namespace Pipeline {
+
+struct NodeBase;
+
+// Evaluations recorded during executions, written in the Chrome trace event format
+// (chrome://tracing, Perfetto): one span per evaluation on the thread that ran it,
+// and a flow event along every edge from the producer's span to the consumer's.
+class ExecutionTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ExecutionTrace();
+    ExecutionTrace(const ExecutionTrace&) = delete;
+    ExecutionTrace& operator=(const ExecutionTrace&) = delete;
+
+    // Starts a new execution, flow events only connect spans of the same execution.
+    void beginExecution();
+    // Thread safe, called by the thread that evaluated the node once the evaluation finished.
+    void record(const NodeBase* node, Clock::time_point begin, Clock::time_point end);
+    void write (std::ostream& stream) const;
+
+private:
+    struct Span {
+        size_t          node;
+        std::thread::id thread;
+        double          begin;
+        double          end;
+    };
+    struct NodeInfo {
+        std::string name;
+        std::string type;
+        size_t      lastSpan;
+        size_t      lastExecution;
+    };
+    struct Flow {
+        size_t from;
+        size_t to;
+    };
+
+    double toMicroseconds(Clock::time_point time) const;
+
+    const Clock::time_point                     m_origin;
+    size_t                                      m_execution;
+    mutable std::mutex                          m_mutex;
+    std::vector<Span>                           m_spans;
+    std::vector<Flow>                           m_flows;
+    std::vector<NodeInfo>                       m_nodeInfos;
+    std::unordered_map<const NodeBase*, size_t> m_nodeIndices;
+};
+
+}
+}
@@ -77,6 +77,11 @@ public:
         }
         return Helper::getValidElement(m_connections)->getOwnerNode();
     }
+    bool hasChanged() const override {
+        return true;
+    }
+    void markSeen() override {
+    }
     const OutputType* getConvertedData() const {
         if (!isDataAvailable()) {
             throw PIPELINE_EXCEPTION("Data is not available on the connected output");
@@ -105,15 +110,23 @@ public:
     bool isDataAvailable() const override {
         return m_data != nullptr;
     }
-    void fillData(unique_ptr<OutputData>&) override {
+    shared_ptr<const OutputData> getDataHandle() const override {
+        throw PIPELINE_EXCEPTION("AdapterOutConn only refers to data, it cannot share it");
+    }
+    void fillData(DataPtr<OutputData>&) override {
         throw PIPELINE_EXCEPTION("fillData should not be called on AdapterOutConn");
     }
+    size_t getVersion() const override {
+        return m_version;
+    }
     void setDataPtr(const OutputData* data) {
         m_data = data;
+        ++m_version;
     }
 
 private:
     const OutputData* m_data;
+    size_t m_version = 0;
 };
 
 template<typename InputTypesTuple, typename OutputType>
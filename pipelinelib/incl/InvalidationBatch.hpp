@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include "NodeBase.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Invalidation is propagated through a worklist instead of recursing through the observers:
+// a node only marks itself invalid and is queued, and the queued nodes notify their observers
+// one after another. While an InvalidationBatch is alive the queue is not drained, so several
+// changes made in its scope are propagated in a single pass when the outermost batch ends.
+// Nodes reached while the batch is open still report valid data until then, so executions
+// cannot start while a batch is open.
+class InvalidationBatch {
+public:
+    InvalidationBatch();
+    ~InvalidationBatch();
+    InvalidationBatch(const InvalidationBatch&) = delete;
+    InvalidationBatch& operator=(const InvalidationBatch&) = delete;
+
+    static bool isActive();
+    static void schedule(NodeBase* node);
+    static void forget  (const NodeBase* node);
+
+private:
+    static void drain();
+};
+
+}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "NodeStructure.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Node turning the value on its single input into the value on its single output. With fusion enabled
+// on the execution, a chain of map nodes each feeding only the next one runs as a single step: the
+// values are passed from node to node in a buffer the node keeps, and only the last node of the chain
+// fills its output. The other nodes are valid but have no data on their output, evaluating them
+// again publishes the value they kept. A chain resumes at its first invalid node, and stops mapping
+// once a node's value didn't change, see Node::enableEarlyCutoff().
+template<typename In, typename Out>
+class MapNode : public Node<tuple<In>, tuple<Out>> {
+    using NodeClass = Node<tuple<In>, tuple<Out>>;
+
+public:
+    using InData  = typename NodeClass::InData;
+    using OutData = typename NodeClass::OutData;
+
+    // Overwrites the output, which holds the result of an earlier call or a default constructed value.
+    virtual void map(const In& in, Out& out) const = 0;
+
+    OutData process(const InData& inData) const final {
+        auto out = NodeClass::template acquireOutputBuffer<0>();
+        map(std::get<0>(inData), *out);
+        return OutData{ std::move(out) };
+    }
+    void evaluate() override {
+        // the output has yet to be published
+        if (m_elided) {
+            evaluateFused(nullptr, true);
+            return;
+        }
+        NodeClass::evaluate();
+    }
+    bool isFusible() const override {
+        return true;
+    }
+    const void* evaluateFused(const void* input, bool publish) override {
+        NodeProfile* const profile = NodeClass::getProfile();
+        if (profile == nullptr) {
+            return evaluateLink(static_cast<const In*>(input), publish, nullptr);
+        }
+        const auto start = NodeProfile::Clock::now();
+        ++profile->evaluations;
+        const void* result = evaluateLink(static_cast<const In*>(input), publish, profile);
+        profile->wallTime += NodeProfile::Clock::now() - start;
+        return result;
+    }
+    bool isOutputElided() const override {
+        return m_elided;
+    }
+
+private:
+    // Maps the value unless the node is valid or its inputs didn't change, then only publishes
+    // the kept value if asked to. Returns the kept value, nullptr when it's on the output.
+    const void* evaluateLink(const In* input, bool publish, NodeProfile* profile) {
+        if (!NodeClass::beginEvaluation(profile, input != nullptr)) {
+            if (m_elided && publish) {
+                auto out = NodeClass::template acquireOutputBuffer<0>();
+                *out = m_value;
+                OutData outData{ std::move(out) };
+                NodeClass::restoreOutputs(outData);
+                m_elided = false;
+            }
+            return m_elided ? &m_value : nullptr;
+        }
+        const In& inValue = input != nullptr ? *input : std::get<0>(NodeClass::getInputData());
+        const auto start = profile != nullptr ? NodeProfile::Clock::now() : NodeProfile::Clock::time_point();
+        if (publish) {
+            auto outData = process(InData{ inValue });
+            addProcessTime(profile, start);
+            NodeClass::finishEvaluation(outData, profile);
+            m_elided = false;
+            return nullptr;
+        }
+        map(inValue, m_next);
+        addProcessTime(profile, start);
+        // a value published before isn't compared, the node doesn't keep it
+        const bool changed = !m_elided || !NodeClass::template isOutputUnchanged<0>(m_value, m_next);
+        std::swap(m_value, m_next);
+        NodeClass::finishWithoutOutputs(profile, changed);
+        m_elided = true;
+        return &m_value;
+    }
+    static void addProcessTime(NodeProfile* profile, NodeProfile::Clock::time_point start) {
+        if (profile != nullptr) {
+            profile->processTime += NodeProfile::Clock::now() - start;
+        }
+    }
+
+    // the output handed to the next node of a chain, and the buffer mapping the next one
+    Out  m_value {};
+    Out  m_next {};
+    bool m_elided = false;
+};
+
+}
+}
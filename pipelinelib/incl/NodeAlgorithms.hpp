@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include <cstddef>
 #include "NodeBase.hpp"
 
@@ -7,6 +8,14 @@ namespace mfep {
 namespace Pipeline {
 
 bool isDependentOn(const NodeBase* node, const NodeBase* dependentNode);
+// Every node endNode depends on and endNode itself, each after all of its inputs.
+std::vector<NodeBase*> collectExecutionOrder(NodeBase* endNode);
+
+// Bumped whenever an edge is added or removed or a node is destroyed anywhere in the process,
+// so cached schedules can tell cheaply that no graph changed since. See NodeBase::getEdgeRevision
+// for the changes of a given node.
+size_t getTopologyRevision();
+void   topologyChanged    ();
 
 }
 }
@@ -1,28 +1,90 @@
 #pragma once
 
+#include <string>
 #include <vector>
+#include <memory>
+#include <exception>
+#include <functional>
 #include "Observer.hpp"
+#include "NodeProfile.hpp"
 
 namespace mfep {
 namespace Pipeline {
 
 struct InConnBase;
 struct OutConnBase;
+class  StreamStage;
 
 struct NodeBase : public Observable, public Observer {
+    // Called once an asynchronous evaluation is over, with its error or nullptr.
+    using EvaluationCallback = std::function<void(std::exception_ptr error)>;
+
+    NodeBase();
+    ~NodeBase() override;
+
     virtual bool                   isConnected    () const = 0;
     virtual bool                   isDataAvailable() const = 0;
+    virtual bool                   isDataValid    () const = 0;
     virtual std::vector<NodeBase*> getInputNodes  () const = 0;
     virtual const OutConnBase*     getOutConn     (size_t index) const = 0;
     virtual void                   evaluate       () = 0;
     virtual void                   connect        (NodeBase& inputNode, size_t inputIdx, size_t outputIdx) = 0;
     virtual void                   disconnect     (size_t inputIdx) = 0;
+    // Whether the node waits for something else than the CPU, like I/O, see AsyncNode.
+    virtual bool                   isAsynchronous () const;
+    // Starts evaluating, done is called once the outputs are filled, possibly from another thread.
+    // Synchronous nodes evaluate right away.
+    virtual void                   evaluateAsync  (EvaluationCallback done);
+    // The node as a stage of a stream, see StreamExecution, with input queues of the given capacity.
+    virtual std::unique_ptr<StreamStage> createStreamStage(size_t queueCapacity);
+    // Whether the node can be fused into a chain, see MapNode and NodeExecution::setFusionEnabled.
+    virtual bool                   isFusible      () const;
+    // Evaluates a fusible node on the given input value, or on its connected input for nullptr. The
+    // last node of a chain publishes its output, the others only keep it for the next node: a pointer
+    // to it is returned, valid until the node is evaluated again, or nullptr when the output has it.
+    virtual const void*            evaluateFused  (const void* input, bool publish);
+    // Whether the node is valid but its output was only handed to the next node of a chain.
+    virtual bool                   isOutputElided () const;
+
+    // Nodes consuming this node's outputs, one entry per connected edge.
+    const std::vector<NodeBase*>& getOutputNodes     () const;
+    // Every edge goes from a lower to a higher order, maintained incrementally on connect.
+    size_t                        getTopologicalOrder() const;
+    // Changes whenever an edge to or from the node is added or removed.
+    size_t                        getEdgeRevision    () const;
+    // Statistics of the evaluations since profiling was enabled, nullptr while it's disabled.
+    NodeProfile*                  getProfile         () const {
+        return m_profile.get();
+    }
+    void                          enableProfiling    (bool enabled);
+    // Optional name identifying the node in traces.
+    const std::string&            getName            () const;
+    void                          setName            (std::string name);
+
+protected:
+    void addInputEdge   (NodeBase& inputNode);
+    void removeInputEdge(NodeBase& inputNode);
+
+private:
+    friend class InvalidationBatch;
+    void reorder      (NodeBase& inputNode);
+    void notifyChanged() const;
+
+    std::vector<NodeBase*>       m_inputEdges;
+    std::vector<NodeBase*>       m_outputNodes;
+    size_t                       m_topologicalOrder;
+    size_t                       m_edgeRevision;
+    bool                         m_visited;
+    std::unique_ptr<NodeProfile> m_profile;
+    std::string                  m_name;
 };
 
 struct OutConnBase {
     virtual ~OutConnBase() = default;
     virtual bool isDataAvailable() const = 0;
     virtual NodeBase* getOwnerNode() const = 0;
+    // Changes whenever the output is filled with a value that may differ from the previous one.
+    virtual size_t getVersion() const = 0;
 };
 
 struct InConnBase {
@@ -31,6 +93,9 @@ struct InConnBase {
     virtual bool      isConnected     () const = 0;
     virtual bool      isDataAvailable () const = 0;
     virtual NodeBase* getConnectedNode() const = 0;
+    // Whether the connected output changed since the last markSeen() call.
+    virtual bool      hasChanged      () const = 0;
+    virtual void      markSeen        () = 0;
 };
 
 }
@@ -1,24 +1,146 @@
 #pragma once
 
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
 #include <vector>
+#include <ostream>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include "NodeBase.hpp"
+#include "Arena.hpp"
+#include "ExecutionTrace.hpp"
+#include "ExecutionHandle.hpp"
 
 namespace mfep {
 namespace Pipeline {
 
+class WorkStealingPool;
+
 class NodeExecution {
 public:
+    explicit NodeExecution(size_t threadCount = 1);
+    ~NodeExecution();
+
     template<typename T>
     T& registerNode(std::unique_ptr<T>&& nodePtr) {
         T* ptr = nodePtr.get();
         m_nodes.push_back(std::move(nodePtr));
         return *ptr;
     }
-    void execute(NodeBase* endNode);
+    // Constructs the node in the execution's arena: nodes are laid out contiguously and
+    // their memory is released in one go when the execution is destroyed.
+    template<typename T, typename ... Args>
+    T& createNode(Args&& ... args) {
+        void* memory = m_arena.allocate(sizeof(T), alignof(T));
+        m_arenaNodes.push_back(nullptr);
+        try {
+            T* ptr = new (memory) T(std::forward<Args>(args)...);
+            m_arenaNodes.back() = ptr;
+            return *ptr;
+        } catch (...) {
+            m_arenaNodes.pop_back();
+            throw;
+        }
+    }
+    void            execute       (NodeBase* endNode);
+    // Starts the execution on the execution's threads and returns right away, a single-threaded
+    // execution gets a background thread for this. The graph must not be modified until it's done,
+    // and starting another execution or querying profiles and costs of the execution throws meanwhile.
+    ExecutionHandle executeAsync  (NodeBase* endNode);
+    size_t          getThreadCount() const;
+
+    // While enabled, every node an executed end node depends on records a NodeProfile.
+    // Disabling drops the collected profiles on the next execution.
+    void setProfilingEnabled(bool enabled);
+    bool isProfilingEnabled () const;
+    // Profiles of the nodes the end node depends on, in execution order.
+    std::vector<std::pair<const NodeBase*, NodeProfile>> getProfiles(NodeBase* endNode);
+
+    // While enabled, chains of fusible nodes (see MapNode) where every node but the last feeds only
+    // the next one are evaluated as a single step, the intermediate values skip the outputs.
+    void setFusionEnabled(bool enabled);
+    bool isFusionEnabled () const;
+
+    // Cost model: evaluate() calls run by the execution are timed, and a node's cost is the moving
+    // average of its durations. Nodes that were never evaluated cost nothing.
+    // The most expensive chain of nodes the end node depends on, starting from a node without inputs.
+    std::vector<const NodeBase*> getCriticalPath (NodeBase* endNode);
+    // Time a full re-evaluation would take on the given number of threads.
+    std::chrono::nanoseconds     estimateMakespan(NodeBase* endNode, size_t threadCount);
+
+    // Records the evaluations of the following executions, until the trace is stopped.
+    // Starting a trace discards the previous one.
+    void startTrace();
+    void stopTrace ();
+    // Writes the last trace as Chrome trace event JSON, to be opened with chrome://tracing or Perfetto.
+    void writeTrace(std::ostream& stream) const;
+    void writeTrace(const std::string& path) const;
 
 private:
-    std::vector<std::unique_ptr<NodeBase>> m_nodes;
+    // Drops the plan of an end node once the node is destroyed.
+    class PlanRelease : public Observer {
+    public:
+        PlanRelease(NodeExecution& execution, NodeBase& endNode);
+
+    private:
+        void targetDeleted() override;
+
+        NodeExecution&  m_execution;
+        const NodeBase* m_endNode;
+    };
+
+    // Topologically ordered schedule of every node the end node depends on,
+    // compiled once and reused until an edge of one of these nodes changes.
+    struct ExecutionPlan {
+        // global topology revision the plan was last checked at, and the edge revision of each node
+        size_t                 topologyRevision;
+        std::vector<size_t>    edgeRevisions;
+        std::vector<NodeBase*> nodes;
+        std::vector<size_t>    inputOffsets;
+        std::vector<size_t>    inputs;
+        std::vector<size_t>    successorOffsets;
+        std::vector<size_t>    successors;
+        // next and previous node of the fused chain each node is part of, NotFused otherwise
+        std::vector<size_t>    fusedSuccessors;
+        std::vector<size_t>    fusedPredecessors;
+        // scratch space of the dirty walk, allocated once per compilation
+        std::vector<size_t>    visitMarks;
+        size_t                 visitEpoch;
+        // nodes to evaluate in the current execution, in topological order
+        std::vector<size_t>    dirtyNodes;
+        // inputs of each dirty node not evaluated yet in the current parallel execution,
+        // decremented by the inputs as they finish: the one reaching zero schedules the node
+        std::unique_ptr<std::atomic<size_t>[]> pendingInputs;
+        // measured cost of the nodes, and the longest path cost from them to the end node
+        // used as their priority: nodes starting long chains are run first
+        std::vector<double>    costs;
+        std::vector<double>    downstreamCosts;
+        size_t                 executionCount;
+        // whether profiling is enabled on the nodes
+        bool                   profiled;
+        std::unique_ptr<PlanRelease> release;
+    };
+
+    // Throws while an asynchronous execution is running, which uses the plans.
+    void           checkIdle        () const;
+    ExecutionPlan& getPlan          (NodeBase* endNode);
+    ExecutionPlan& startExecution   (NodeBase* endNode);
+    void           collectDirtyNodes(ExecutionPlan& plan);
+
+    Arena                                              m_arena;
+    std::vector<NodeBase*>                             m_arenaNodes;
+    std::vector<std::unique_ptr<NodeBase>>             m_nodes;
+    std::unordered_map<const NodeBase*, ExecutionPlan> m_plans;
+    const size_t                                       m_threadCount;
+    std::unique_ptr<WorkStealingPool>                  m_threadPool;
+    std::shared_ptr<ExecutionHandle::State>            m_running;
+    bool                                               m_profilingEnabled;
+    bool                                               m_fusionEnabled;
+    std::unique_ptr<ExecutionTrace>                    m_trace;
+    bool                                               m_tracing;
 };
 
 }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace mfep {
+namespace Pipeline {
+
+// Statistics of a node's evaluations, collected only while profiling is enabled on the node.
+struct NodeProfile {
+    using Clock    = std::chrono::steady_clock;
+    using Duration = std::chrono::nanoseconds;
+
+    size_t   evaluations  = 0;   // evaluate() calls
+    size_t   processCalls = 0;   // evaluations that ran process()
+    size_t   cacheHits    = 0;   // requests served by the still valid output
+    size_t   reuses       = 0;   // evaluations where the early cutoff skipped process()
+    Duration wallTime     {};    // total time spent in evaluate()
+    Duration processTime  {};    // total time spent in process()
+    size_t   outputBytes  = 0;   // size of the outputs produced by the last process() call
+};
+
+// Number of bytes held by a value, used for the output size of profiled nodes.
+// Specialise it for types owning heap memory.
+template<typename T>
+struct DataSize {
+    static size_t get(const T&) {
+        return sizeof(T);
+    }
+};
+template<typename T, typename Allocator>
+struct DataSize<std::vector<T, Allocator>> {
+    static size_t get(const std::vector<T, Allocator>& data) {
+        return sizeof(data) + data.capacity() * sizeof(T);
+    }
+};
+template<typename CharT, typename Traits, typename Allocator>
+struct DataSize<std::basic_string<CharT, Traits, Allocator>> {
+    static size_t get(const std::basic_string<CharT, Traits, Allocator>& data) {
+        return sizeof(data) + data.capacity() * sizeof(CharT);
+    }
+};
+
+}
+}
@@ -6,17 +6,77 @@
 #include <algorithm>
 #include "PipelineException.hpp"
 #include "NodeAlgorithms.hpp"
+#include "InvalidationBatch.hpp"
+#include "StreamQueue.hpp"
 
 namespace mfep {
 namespace Pipeline {
 
 using std::unique_ptr;
+using std::shared_ptr;
 using std::array;
 using std::tuple;
 
+// Output data produced by a node: either exclusively owned, or an immutable handle that
+// may be shared with other outputs, so data can be forwarded through the graph without copying.
+template<typename T>
+class DataPtr {
+public:
+    DataPtr() = default;
+    DataPtr(std::nullptr_t)
+    {
+    }
+    DataPtr(unique_ptr<T>&& data) : m_unique(std::move(data))
+    {
+    }
+    template<typename U, typename = std::enable_if_t<std::is_convertible<U*, const T*>::value>>
+    DataPtr(shared_ptr<U> data) : m_shared(std::move(data))
+    {
+    }
+    const T* get() const {
+        return m_unique != nullptr ? m_unique.get() : m_shared.get();
+    }
+    const T& operator*() const {
+        return *get();
+    }
+    const T* operator->() const {
+        return get();
+    }
+    bool operator==(std::nullptr_t) const {
+        return get() == nullptr;
+    }
+    bool operator!=(std::nullptr_t) const {
+        return get() != nullptr;
+    }
+    bool isShared() const {
+        return m_shared != nullptr;
+    }
+    // Takes back exclusively owned data, shared handles are left untouched.
+    unique_ptr<T> releaseUnique() {
+        return std::move(m_unique);
+    }
+    // The shared handle, or a shared copy when the data is exclusively owned.
+    shared_ptr<const T> share() const {
+        if (m_unique != nullptr) {
+            return std::make_shared<const T>(*m_unique);
+        }
+        return m_shared;
+    }
+    void reset() {
+        m_unique.reset();
+        m_shared.reset();
+    }
+
+private:
+    unique_ptr<T>       m_unique;
+    shared_ptr<const T> m_shared;
+};
+
 template<typename T>
 class OutConn : public OutConnBase {
 public:
+    using EqualityCheck = bool (*)(const T&, const T&);
+
     explicit OutConn(NodeBase* ownerNode) : m_ownerNode(ownerNode)
     {
     }
@@ -26,6 +86,9 @@ public:
     NodeBase* getOwnerNode() const override {
         return m_ownerNode;
     }
+    size_t getVersion() const override {
+        return m_version;
+    }
     virtual const T& getData() const {
         if (m_data == nullptr) {
             throw PIPELINE_EXCEPTION("Data pointer is null");
@@ -33,13 +96,69 @@ public:
         return *m_data;
     }
 
-    virtual void fillData(unique_ptr<T>& newData) {
-        m_data = std::move(newData);
+    // Shares the stored handle, only outputs filled with exclusively owned data need a copy.
+    virtual shared_ptr<const T> getDataHandle() const {
+        if (m_data == nullptr) {
+            throw PIPELINE_EXCEPTION("Data pointer is null");
+        }
+        return m_data.share();
+    }
+
+    virtual void fillData(DataPtr<T>& newData) {
+        if (m_data != nullptr && newData != nullptr && isUnchanged(*m_data, *newData)) {
+            // keep the current value and version, consumers don't need to recompute
+            recycle(newData);
+            return;
+        }
+        std::swap(m_data, newData);
+        recycle(newData);
+        ++m_version;
+    }
+    // Drops the value, which is kept as the spare buffer when recycling. The consumers were handed
+    // the new value some other way, it only counts as a new version when it changed.
+    void clearData(bool changed) {
+        recycle(m_data);
+        if (changed) {
+            ++m_version;
+        }
+    }
+    // Publishes again a value the consumers were handed already, without a new version.
+    void restoreData(DataPtr<T>& data) {
+        std::swap(m_data, data);
+        recycle(data);
+    }
+    void setEqualityCheck(EqualityCheck equalityCheck) {
+        m_equalityCheck = equalityCheck;
+    }
+    // Whether the early cutoff check finds the values equal, false without a check.
+    bool isUnchanged(const T& previous, const T& value) const {
+        return m_equalityCheck != nullptr && m_equalityCheck(previous, value);
+    }
+    // A buffer to overwrite with the next value. Once a buffer was acquired, replaced values
+    // that were exclusively owned are kept as a spare instead of being freed, so steady-state
+    // evaluations alternate between two buffers without allocating.
+    unique_ptr<T> acquireBuffer() const {
+        m_recycling = true;
+        if (m_spare != nullptr) {
+            return std::move(m_spare);
+        }
+        return std::make_unique<T>();
     }
 
 private:
-    unique_ptr<T> m_data = nullptr;
+    void recycle(DataPtr<T>& data) {
+        if (m_recycling && m_spare == nullptr) {
+            m_spare = data.releaseUnique();
+        }
+        data.reset();
+    }
+
+    DataPtr<T> m_data = nullptr;
     NodeBase* const m_ownerNode;
+    size_t m_version = 0;
+    EqualityCheck m_equalityCheck = nullptr;
+    mutable unique_ptr<T> m_spare = nullptr;
+    mutable bool m_recycling = false;
 };
 
 struct DummyInConn : public InConnBase {
@@ -55,6 +174,11 @@ struct DummyInConn : public InConnBase {
     NodeBase* getConnectedNode() const override {
         return nullptr;
     }
+    bool hasChanged() const override {
+        return false;
+    }
+    void markSeen() override {
+    }
 };
 
 template<typename T>
@@ -74,6 +198,7 @@ public:
             m_outConn = outConnCast;
             m_outConn->getOwnerNode()->attach(this);
         }
+        m_seenVersion = NotSeen;
     }
     bool isConnected() const override {
         return m_outConn != nullptr;
@@ -87,12 +212,27 @@ public:
     NodeBase* getConnectedNode() const override {
         return isConnected() ? m_outConn->getOwnerNode() : nullptr;
     }
+    const OutConn<T>* getConnectedOutput() const {
+        return m_outConn;
+    }
     const T& getData() const {
         if (!isDataAvailable()) {
             throw PIPELINE_EXCEPTION("Data is not available on the connected output");
         }
         return m_outConn->getData();
     }
+    shared_ptr<const T> getDataHandle() const {
+        if (!isDataAvailable()) {
+            throw PIPELINE_EXCEPTION("Data is not available on the connected output");
+        }
+        return m_outConn->getDataHandle();
+    }
+    bool hasChanged() const override {
+        return !isConnected() || m_outConn->getVersion() != m_seenVersion;
+    }
+    void markSeen() override {
+        m_seenVersion = isConnected() ? m_outConn->getVersion() : NotSeen;
+    }
 
 protected:
     void targetDeleted() override {
@@ -100,7 +240,9 @@ protected:
     }
 
 private:
+    static constexpr size_t NotSeen = static_cast<size_t>(-1);
     const OutConn<T>* m_outConn = nullptr;
+    size_t m_seenVersion = NotSeen;
 };
 
 template<typename PtrT, typename Tuple, size_t ... Indices>
@@ -131,15 +273,207 @@ inline tuple<> extractDataFromInputs(const tuple<DummyInConn>&) {
 }
 
 template<typename ... DataTs, size_t ... Indices>
-void fillOutputsDataImpl(tuple<OutConn<DataTs>...>& outputs, tuple<unique_ptr<DataTs>...>& data, std::index_sequence<Indices...>) {
+void fillOutputsDataImpl(tuple<OutConn<DataTs>...>& outputs, tuple<DataPtr<DataTs>...>& data, std::index_sequence<Indices...>) {
     using swallow = int[];
     (void)swallow{ (std::get<Indices>(outputs).fillData(std::get<Indices>(data)),1)... };
 }
 template<typename ... DataTs>
-void fillOutputsData(tuple<OutConn<DataTs>...>& outputs, tuple<unique_ptr<DataTs>...>& data) {
+void fillOutputsData(tuple<OutConn<DataTs>...>& outputs, tuple<DataPtr<DataTs>...>& data) {
     fillOutputsDataImpl(outputs, data, std::index_sequence_for<DataTs...>{});
 }
 
+template<typename ... DataTs, size_t ... Indices>
+void clearOutputsDataImpl(tuple<OutConn<DataTs>...>& outputs, bool changed, std::index_sequence<Indices...>) {
+    using swallow = int[];
+    (void)swallow{ (std::get<Indices>(outputs).clearData(changed), 1)... };
+}
+template<typename ... DataTs>
+void clearOutputsData(tuple<OutConn<DataTs>...>& outputs, bool changed) {
+    clearOutputsDataImpl(outputs, changed, std::index_sequence_for<DataTs...>{});
+}
+
+template<typename ... DataTs, size_t ... Indices>
+void restoreOutputsDataImpl(tuple<OutConn<DataTs>...>& outputs, tuple<DataPtr<DataTs>...>& data, std::index_sequence<Indices...>) {
+    using swallow = int[];
+    (void)swallow{ (std::get<Indices>(outputs).restoreData(std::get<Indices>(data)), 1)... };
+}
+template<typename ... DataTs>
+void restoreOutputsData(tuple<OutConn<DataTs>...>& outputs, tuple<DataPtr<DataTs>...>& data) {
+    restoreOutputsDataImpl(outputs, data, std::index_sequence_for<DataTs...>{});
+}
+
+template<typename ... DataTs, size_t ... Indices>
+size_t getOutputsDataSizeImpl(const tuple<DataPtr<DataTs>...>& data, std::index_sequence<Indices...>) {
+    size_t size = 0;
+    using swallow = int[];
+    (void)swallow{ (size += std::get<Indices>(data) != nullptr ? DataSize<DataTs>::get(*std::get<Indices>(data)) : 0, 1)... };
+    return size;
+}
+template<typename ... DataTs>
+size_t getOutputsDataSize(const tuple<DataPtr<DataTs>...>& data) {
+    return getOutputsDataSizeImpl(data, std::index_sequence_for<DataTs...>{});
+}
+
+template<typename ... DataTs, size_t ... Indices>
+array<const OutConnBase*, sizeof...(DataTs)> getConnectedOutputsImpl(const tuple<InConn<DataTs>...>& inputConns, std::index_sequence<Indices...>) {
+    return { { std::get<Indices>(inputConns).getConnectedOutput()... } };
+}
+template<typename ... DataTs>
+array<const OutConnBase*, sizeof...(DataTs)> getConnectedOutputs(const tuple<InConn<DataTs>...>& inputConns) {
+    return getConnectedOutputsImpl(inputConns, std::index_sequence_for<DataTs...>{});
+}
+inline array<const OutConnBase*, 0> getConnectedOutputs(const tuple<DummyInConn>&) {
+    return {};
+}
+
+// Input queues of a node running in a stream, one item of each makes up an input of process().
+template<typename InTup>
+class StreamInputs {
+};
+template<typename ... DataTs>
+class StreamInputs<tuple<DataTs...>> {
+public:
+    using Items = tuple<shared_ptr<const DataTs>...>;
+    static constexpr size_t Count = sizeof...(DataTs);
+
+    // Options of each input's edge, the default capacity applies to edges without one.
+    StreamInputs(const array<EdgeOptions, Count>& options, size_t defaultCapacity) :
+        StreamInputs(options, defaultCapacity, std::index_sequence_for<DataTs...>{})
+    {
+    }
+    StreamQueueBase& getQueue(size_t index) {
+        if (index >= Count) {
+            throw PIPELINE_EXCEPTION("Input overindexed");
+        }
+        return *m_queueBases[index];
+    }
+    // False once an input's stream ended.
+    bool pop(Items& items) {
+        return popImpl(items, std::index_sequence_for<DataTs...>{});
+    }
+    // Only takes items that are already queued, false unless every input has one: nothing is taken
+    // then, so an item never gets lost for lack of items on the other inputs.
+    bool tryPop(Items& items) {
+        return tryPopImpl(items, std::index_sequence_for<DataTs...>{});
+    }
+    static tuple<const DataTs&...> getData(const Items& items) {
+        return getDataImpl(items, std::index_sequence_for<DataTs...>{});
+    }
+    void abandon() {
+        for (auto* queue : m_queueBases) {
+            queue->abandon();
+        }
+    }
+
+private:
+    template<size_t ... Indices>
+    StreamInputs(const array<EdgeOptions, Count>& options, size_t defaultCapacity, std::index_sequence<Indices...>) :
+        m_queues(std::make_unique<StreamQueue<DataTs>>(
+            options[Indices].capacity > 0 ? options[Indices].capacity : defaultCapacity,
+            options[Indices].backpressure)...),
+        m_queueBases(getBases(std::index_sequence_for<DataTs...>{}))
+    {
+        // stream sources have no inputs to use them for
+        (void)options;
+        (void)defaultCapacity;
+    }
+    template<size_t ... Indices>
+    array<StreamQueueBase*, Count> getBases(std::index_sequence<Indices...>) const {
+        return { { std::get<Indices>(m_queues).get()... } };
+    }
+    template<size_t ... Indices>
+    bool popImpl(Items& items, std::index_sequence<Indices...>) {
+        bool open = true;
+        using swallow = int[];
+        (void)swallow{ 0, (open = open && std::get<Indices>(m_queues)->pop(std::get<Indices>(items)), 1)... };
+        return open;
+    }
+    template<size_t First, size_t ... Indices>
+    bool tryPopImpl(Items& items, std::index_sequence<First, Indices...>) {
+        // edges into a node with several inputs never drop items, what's queued stays for this consumer:
+        // the first input is only popped once the others have an item each
+        bool queued = true;
+        using swallow = int[];
+        (void)swallow{ 0, (queued = queued && !std::get<Indices>(m_queues)->isEmpty(), 1)... };
+        if (!queued) {
+            return false;
+        }
+        bool popped = std::get<First>(m_queues)->tryPop(std::get<First>(items));
+        (void)swallow{ 0, (popped = popped && std::get<Indices>(m_queues)->tryPop(std::get<Indices>(items)), 1)... };
+        return popped;
+    }
+    bool tryPopImpl(Items&, std::index_sequence<>) {
+        return false;
+    }
+    template<size_t ... Indices>
+    static tuple<const DataTs&...> getDataImpl(const Items& items, std::index_sequence<Indices...>) {
+        return tuple<const DataTs&...>{ *std::get<Indices>(items)... };
+    }
+
+    tuple<unique_ptr<StreamQueue<DataTs>>...> m_queues;
+    array<StreamQueueBase*, Count>            m_queueBases;
+};
+
+// Queues subscribed to the outputs of a node running in a stream. The queues of an output share
+// its items, exclusively owned outputs are handed over without copying.
+template<typename OutTup>
+class StreamOutputs {
+};
+template<typename ... DataTs>
+class StreamOutputs<tuple<DataTs...>> {
+public:
+    static constexpr size_t Count = sizeof...(DataTs);
+
+    static unique_ptr<StreamQueueBase> createQueue(size_t index, size_t capacity, Backpressure backpressure) {
+        using Factory = unique_ptr<StreamQueueBase> (*)(size_t, Backpressure);
+        static const array<Factory, Count> factories { { &StreamQueue<DataTs>::create... } };
+        if (index >= Count) {
+            throw PIPELINE_EXCEPTION("Output overindexed");
+        }
+        return factories[index](capacity, backpressure);
+    }
+    void subscribe(size_t index, StreamQueueBase& queue) {
+        if (index >= Count) {
+            throw PIPELINE_EXCEPTION("Output overindexed");
+        }
+        m_queues[index].push_back(&queue);
+    }
+    void push(tuple<DataPtr<DataTs>...>& data) {
+        pushImpl(data, std::index_sequence_for<DataTs...>{});
+    }
+    template<size_t Index>
+    void push(shared_ptr<const std::tuple_element_t<Index, tuple<DataTs...>>> item) {
+        using T = std::tuple_element_t<Index, tuple<DataTs...>>;
+        for (auto* queue : m_queues[Index]) {
+            static_cast<StreamQueue<T>*>(queue)->push(item);
+        }
+    }
+    void close() {
+        for (auto& queues : m_queues) {
+            for (auto* queue : queues) {
+                queue->close();
+            }
+        }
+    }
+
+private:
+    template<size_t ... Indices>
+    void pushImpl(tuple<DataPtr<DataTs>...>& data, std::index_sequence<Indices...>) {
+        using swallow = int[];
+        (void)swallow{ (push<Indices>(share(std::get<Indices>(data))), 1)... };
+    }
+    template<typename T>
+    static shared_ptr<const T> share(DataPtr<T>& data) {
+        if (data == nullptr) {
+            throw PIPELINE_EXCEPTION("Nodes in a stream have to fill every output");
+        }
+        unique_ptr<T> unique = data.releaseUnique();
+        return unique != nullptr ? shared_ptr<const T>(std::move(unique)) : data.share();
+    }
+
+    array<std::vector<StreamQueueBase*>, Count> m_queues;
+};
+
 template<typename ... DataTs>
 struct ConnTupHelper {
 };
@@ -154,7 +488,7 @@ template<typename ... DataTs>
 struct ConnTupHelper<tuple<DataTs...>> {
     using inTupleType  = tuple<InConn<DataTs>...>;
     using outTupleType = tuple<OutConn<DataTs>...>;
-    using outDataType  = tuple<unique_ptr<DataTs>...>;
+    using outDataType  = tuple<DataPtr<DataTs>...>;
     using inDataType   = tuple<const DataTs&...>;
 
     static constexpr size_t DataSize = sizeof...(DataTs);
@@ -173,9 +507,13 @@ public:
     NodeBaseInOut(const InArrayT& inArray, const OutArrayT& outArray) :
         m_inArr(inArray),
         m_outArr(outArray),
-        m_isDataValid(false)
+        m_isDataValid(false),
+        m_processRequired(true)
     {
     }
+    ~NodeBaseInOut() override {
+        topologyChanged();
+    }
     bool isConnected() const override {
         for (const auto* inConn : m_inArr) {
             if (!inConn->isConnected()) {
@@ -195,6 +533,9 @@ public:
         }
         return true;
     }
+    bool isDataValid() const override {
+        return m_isDataValid;
+    }
     std::vector<NodeBase*> getInputNodes() const override {
         std::vector<NodeBase*> retval;
         for (const auto& inputNode : m_inArr) {
@@ -212,34 +553,99 @@ public:
         return m_outArr[index];
     }
     void connect(NodeBase& inputNode, size_t inputIdx, size_t outputIdx) override {
-        if (isDependentOn(this, &inputNode)) {
-            throw PIPELINE_EXCEPTION("Cannot connect: output node is dependent on input node");
+        InConnBase* inConn = getInConn(inputIdx);
+        NodeBase* previousNode = inConn->getConnectedNode();
+        addInputEdge(inputNode);
+        try {
+            inConn->connect(inputNode.getOutConn(outputIdx));
+        } catch (...) {
+            removeInputEdge(inputNode);
+            throw;
+        }
+        if (previousNode != nullptr) {
+            previousNode->detach(this);
+            removeInputEdge(*previousNode);
         }
-        getInConn(inputIdx)->connect(inputNode.getOutConn(outputIdx));
         inputNode.attach(this);
+        m_edgeOptions[inputIdx] = EdgeOptions();
+        topologyChanged();
         invalidate();
     }
+    // Connects with the options of the edge, which apply when the node runs in a stream. A node with
+    // several inputs pairs their items in order, dropping items on one edge would pair unrelated ones.
+    void connect(NodeBase& inputNode, size_t inputIdx, size_t outputIdx, const EdgeOptions& options) {
+        if (NumInputs > 1 && options.backpressure != Backpressure::Block) {
+            throw PIPELINE_EXCEPTION("Only nodes with a single input can drop items");
+        }
+        connect(inputNode, inputIdx, outputIdx);
+        m_edgeOptions[inputIdx] = options;
+    }
+    const EdgeOptions& getEdgeOptions(size_t inputIdx) const {
+        if (inputIdx >= m_edgeOptions.size()) {
+            throw PIPELINE_EXCEPTION("Input overindexed");
+        }
+        return m_edgeOptions[inputIdx];
+    }
     void disconnect(size_t inputIdx) override {
-        getInConn(inputIdx)->getConnectedNode()->detach(this);
+        NodeBase* inputNode = getInConn(inputIdx)->getConnectedNode();
+        inputNode->detach(this);
+        removeInputEdge(*inputNode);
         getInConn(inputIdx)->connect(nullptr);
+        m_edgeOptions[inputIdx] = EdgeOptions();
+        topologyChanged();
         invalidate();
     }
 
 protected:
     void invalidate() {
-        m_isDataValid = false;
-        changed();
+        m_processRequired = true;
+        markInvalid();
     }
-    bool isDataValid() {
-        return m_isDataValid;
+    // True when the last results can be reused because only upstream nodes were re-evaluated
+    // and none of them produced a different output.
+    bool canReuseOutputs() const {
+        if (m_processRequired) {
+            return false;
+        }
+        for (const auto* inConn : m_inArr) {
+            if (inConn->hasChanged()) {
+                return false;
+            }
+        }
+        // outputs held back in a fused chain are kept by the node
+        for (const auto* outConn : m_outArr) {
+            if (!outConn->isDataAvailable() && !isOutputElided()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    void processed() {
+        for (auto* inConn : m_inArr) {
+            inConn->markSeen();
+        }
+        m_processRequired = false;
+        executed();
     }
     void executed() {
-        m_isDataValid = true;
+        // output computed from stale inputs stays invalid, so a valid node always has a valid upstream
+        m_isDataValid = std::all_of(m_inArr.begin(), m_inArr.end(), [](const InConnBase* inConn){
+            const NodeBase* inputNode = inConn->getConnectedNode();
+            return inputNode == nullptr || inputNode->isDataValid();
+        });
     }
 
 private:
     void targetChanged() override {
-        invalidate();
+        markInvalid();
+    }
+    void markInvalid() {
+        // an invalid node's whole downstream is invalid already
+        if (!m_isDataValid) {
+            return;
+        }
+        m_isDataValid = false;
+        InvalidationBatch::schedule(this);
     }
     void targetDeleted() override {
         invalidate();
@@ -253,7 +659,9 @@ private:
 
     InArrayT   m_inArr;
     OutArrayT m_outArr;
+    std::array<EdgeOptions, NumInputs> m_edgeOptions;
     bool m_isDataValid;
+    bool m_processRequired;
 };
 
 template<typename InTup, typename OutTup>
@@ -262,31 +670,210 @@ public:
     Node () :
         NodeBaseClass(tupleToArray<InConnBase*, InConnTup>(m_inTup), tupleToArray<OutConnBase*, OutConnTup>(m_outTup)),
         m_inTup (),
-        m_outTup (ConnTupHelper<OutTup>::createOutTuple(this))
+        m_outTup (ConnTupHelper<OutTup>::createOutTuple(this)),
+        m_streamItems (nullptr)
     {
     }
     void evaluate() override {
-        if (NodeBaseClass::isDataValid()) {
+        NodeProfile* const profile = NodeBaseClass::getProfile();
+        if (profile == nullptr) {
+            evaluateOutputs(nullptr);
             return;
         }
-        if(!NodeBaseClass::isDataAvailable()) {
-            throw PIPELINE_EXCEPTION("Cannot evaluate, there's no data on every input");
-        }
-        auto inputData = extractDataFromInputs(m_inTup);
-        auto outData = process(inputData);
-        fillOutputsData(m_outTup, outData);
-        NodeBaseClass::executed();
+        const auto start = NodeProfile::Clock::now();
+        ++profile->evaluations;
+        evaluateOutputs(profile);
+        profile->wallTime += NodeProfile::Clock::now() - start;
+    }
+    unique_ptr<StreamStage> createStreamStage(size_t queueCapacity) override {
+        return std::make_unique<Stream>(*this, queueCapacity);
     }
     using InData  = typename ConnTupHelper<InTup>::inDataType;
     using OutData = typename ConnTupHelper<OutTup>::outDataType;
+    template<size_t Index>
+    using InType  = std::tuple_element_t<Index, InTup>;
+    template<size_t Index>
+    using OutType = std::tuple_element_t<Index, OutTup>;
     virtual OutData process(const InData& inData) const = 0;
 
+    // Early cutoff: an output filled with a value equal to the previous one doesn't make
+    // the consumers run process() again.
+    template<size_t Index>
+    void enableEarlyCutoff() {
+        enableEarlyCutoff<Index>([](const OutType<Index>& lhs, const OutType<Index>& rhs){ return lhs == rhs; });
+    }
+    template<size_t Index>
+    void enableEarlyCutoff(typename OutConn<OutType<Index>>::EqualityCheck equalityCheck) {
+        std::get<Index>(m_outTup).setEqualityCheck(equalityCheck);
+    }
+
+protected:
+    // Handle to the data on an input, which process() can publish as an output to forward it without copying.
+    template<size_t Index>
+    shared_ptr<const InType<Index>> getInputHandle() const {
+        if (m_streamItems != nullptr) {
+            return std::get<Index>(*m_streamItems);
+        }
+        return std::get<Index>(m_inTup).getDataHandle();
+    }
+    // Recycled buffer for an output, holding a stale value that process() overwrites in place.
+    template<size_t Index>
+    unique_ptr<OutType<Index>> acquireOutputBuffer() const {
+        return std::get<Index>(m_outTup).acquireBuffer();
+    }
+
+    // Steps of an evaluation, for nodes that run process() differently. Whether process() has to run,
+    // false when the outputs are valid or can be reused. Inputs handed over by the previous node of a
+    // fused chain aren't on the connections.
+    bool beginEvaluation(NodeProfile* profile, bool inputsHandedOver = false) {
+        if (NodeBaseClass::isDataValid()) {
+            if (profile != nullptr) {
+                ++profile->cacheHits;
+            }
+            return false;
+        }
+        if (!inputsHandedOver && !NodeBaseClass::isDataAvailable()) {
+            throw PIPELINE_EXCEPTION("Cannot evaluate, there's no data on every input");
+        }
+        if (NodeBaseClass::canReuseOutputs()) {
+            if (profile != nullptr) {
+                ++profile->reuses;
+            }
+            NodeBaseClass::executed();
+            return false;
+        }
+        return true;
+    }
+    InData getInputData() const {
+        return extractDataFromInputs(m_inTup);
+    }
+    void finishEvaluation(OutData& outData, NodeProfile* profile) {
+        if (profile != nullptr) {
+            ++profile->processCalls;
+            profile->outputBytes = getOutputsDataSize(outData);
+        }
+        fillOutputsData(m_outTup, outData);
+        NodeBaseClass::processed();
+    }
+    // Finishes an evaluation whose results were handed over without the outputs, which are left empty.
+    // Whether they changed tells the consumers if they have to run process() again.
+    void finishWithoutOutputs(NodeProfile* profile, bool changed) {
+        if (profile != nullptr) {
+            ++profile->processCalls;
+            profile->outputBytes = 0;
+        }
+        clearOutputsData(m_outTup, changed);
+        NodeBaseClass::processed();
+    }
+    // Publishes the results finishWithoutOutputs() handed over, the consumers don't see them as new.
+    void restoreOutputs(OutData& outData) {
+        restoreOutputsData(m_outTup, outData);
+    }
+    // Whether the early cutoff of the output finds the values equal, see enableEarlyCutoff().
+    template<size_t Index>
+    bool isOutputUnchanged(const OutType<Index>& previous, const OutType<Index>& value) const {
+        return std::get<Index>(m_outTup).isUnchanged(previous, value);
+    }
+
+    // Runs process() on every set of input items, in the stage's own thread. Derived nodes can
+    // replace step() to handle the items differently.
+    class Stream : public StreamStage {
+    public:
+        Stream(Node& node, size_t capacity) :
+            m_node(node),
+            m_inputs(getEdgeOptions(node), capacity)
+        {
+        }
+        size_t getInputCount() const override {
+            return StreamInputs<InTup>::Count;
+        }
+        StreamQueueBase& getInput(size_t inputIdx) override {
+            return m_inputs.getQueue(inputIdx);
+        }
+        const OutConnBase* getInputSource(size_t inputIdx) const override {
+            if (inputIdx >= StreamInputs<InTup>::Count) {
+                throw PIPELINE_EXCEPTION("Input overindexed");
+            }
+            return getConnectedOutputs(m_node.m_inTup)[inputIdx];
+        }
+        size_t getOutputCount() const override {
+            return StreamOutputs<OutTup>::Count;
+        }
+        unique_ptr<StreamQueueBase> createQueue(size_t outputIdx, size_t capacity, Backpressure backpressure) const override {
+            return StreamOutputs<OutTup>::createQueue(outputIdx, capacity, backpressure);
+        }
+        void subscribe(const OutConnBase* output, StreamQueueBase& queue) override {
+            for (size_t i = 0; i < StreamOutputs<OutTup>::Count; ++i) {
+                if (m_node.getOutConn(i) == output) {
+                    m_outputs.subscribe(i, queue);
+                    return;
+                }
+            }
+            throw PIPELINE_EXCEPTION("The output doesn't belong to the node");
+        }
+        bool step() override {
+            if (StreamInputs<InTup>::Count == 0) {
+                throw PIPELINE_EXCEPTION("Only stream sources can start a stream");
+            }
+            typename StreamInputs<InTup>::Items items;
+            if (!m_inputs.pop(items)) {
+                return false;
+            }
+            m_node.m_streamItems = &items;
+            try {
+                auto outData = m_node.process(StreamInputs<InTup>::getData(items));
+                m_node.m_streamItems = nullptr;
+                m_outputs.push(outData);
+            } catch (...) {
+                m_node.m_streamItems = nullptr;
+                throw;
+            }
+            return true;
+        }
+        void close() override {
+            m_inputs.abandon();
+            m_outputs.close();
+        }
+
+    protected:
+        static array<EdgeOptions, StreamInputs<InTup>::Count> getEdgeOptions(const Node& node) {
+            array<EdgeOptions, StreamInputs<InTup>::Count> options;
+            for (size_t i = 0; i < options.size(); ++i) {
+                options[i] = node.getEdgeOptions(i);
+            }
+            return options;
+        }
+
+        Node&                 m_node;
+        StreamInputs<InTup>   m_inputs;
+        StreamOutputs<OutTup> m_outputs;
+    };
+
 private:
     using NodeBaseClass = NodeBaseInOut<ConnTupHelper<InTup>::DataSize, ConnTupHelper<OutTup>::DataSize>;
+
+    void evaluateOutputs(NodeProfile* profile) {
+        if (!beginEvaluation(profile)) {
+            return;
+        }
+        auto inputData = getInputData();
+        if (profile == nullptr) {
+            auto outData = process(inputData);
+            finishEvaluation(outData, nullptr);
+        } else {
+            const auto start = NodeProfile::Clock::now();
+            auto outData = process(inputData);
+            profile->processTime += NodeProfile::Clock::now() - start;
+            finishEvaluation(outData, profile);
+        }
+    }
+
     using InConnTup  = typename ConnTupHelper<InTup>::inTupleType;
     using OutConnTup = typename ConnTupHelper<OutTup>::outTupleType;
     InConnTup  m_inTup;
     OutConnTup m_outTup;
+    // the items process() runs on while the node is a stage of a stream
+    const typename StreamInputs<InTup>::Items* m_streamItems;
 };
 
 }   // namespace Pipeline
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <set>
+#include <vector>
 #include "PipelineException.hpp"
 
 namespace mfep {
@@ -8,8 +8,15 @@ namespace Pipeline {
 
 class Observer;
 
+// Observers and their targets are kept in flat vectors that cross-reference each other's
+// slots, so notification iterates contiguous memory and detaching is a swap-and-pop.
+// An observer may watch several targets and may be attached to the same target more than once.
 class Observable {
+friend class Observer;
 public:
+    Observable() = default;
+    Observable(const Observable&) = delete;
+    Observable& operator=(const Observable&) = delete;
     virtual ~Observable();
     void attach(Observer* obs);
     void detach(Observer* obs);
@@ -18,12 +25,21 @@ protected:
     void changed() const;
 
 private:
-    std::set<Observer*> m_observers;
+    struct Link {
+        Observer* observer;
+        size_t    observerSlot;
+    };
+    void removeLink(size_t slot);
+
+    std::vector<Link> m_observers;
 };
 
 class Observer {
 friend class Observable;
 public:
+    Observer() = default;
+    Observer(const Observer&) = delete;
+    Observer& operator=(const Observer&) = delete;
     virtual ~Observer();
 
 protected:
@@ -31,7 +47,13 @@ protected:
     virtual void targetChanged();
 
 private:
-    Observable* m_target = nullptr;
+    struct Subscription {
+        Observable* target;
+        size_t      targetSlot;
+    };
+    void removeSubscription(size_t slot);
+
+    std::vector<Subscription> m_targets;
 };
 
 }
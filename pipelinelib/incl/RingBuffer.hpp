@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include "PipelineException.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Bounded lock-free queue for any number of producers and consumers (Vyukov): every cell carries a
+// sequence number telling whether it's free for the push or filled for the pop of a given position,
+// so producers and consumers only contend on their own position counter. The sequence is twice the
+// position when the cell is free and one more when it's filled, which keeps the two apart even when
+// a single cell is reused on every lap.
+template<typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) :
+        m_capacity(capacity),
+        m_cells(capacity > 0 ? new Cell[capacity] : nullptr),
+        m_pushPosition(0),
+        m_popPosition(0)
+    {
+        if (capacity == 0) {
+            throw PIPELINE_EXCEPTION("Ring buffers need room for at least one item");
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            m_cells[i].sequence.store(2 * i, std::memory_order_relaxed);
+        }
+    }
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // False when the buffer is full, the item is left untouched then.
+    bool tryPush(T& item) {
+        size_t position = m_pushPosition.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_cells[position % m_capacity];
+            const auto difference = static_cast<std::ptrdiff_t>(cell.sequence.load(std::memory_order_acquire) - 2 * position);
+            if (difference == 0) {
+                if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.item = std::move(item);
+                    cell.sequence.store(2 * position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // the cell still holds the item from a lap ago
+                return false;
+            } else {
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    // False when the buffer is empty.
+    bool tryPop(T& item) {
+        size_t position = m_popPosition.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_cells[position % m_capacity];
+            const auto difference = static_cast<std::ptrdiff_t>(cell.sequence.load(std::memory_order_acquire) - (2 * position + 1));
+            if (difference == 0) {
+                if (m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    item = std::move(cell.item);
+                    cell.item = T();
+                    cell.sequence.store(2 * (position + m_capacity), std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = m_popPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    // Whether the next pop finds no item, only a hint while others pop at the same time.
+    bool isEmpty() const {
+        const size_t position = m_popPosition.load(std::memory_order_relaxed);
+        return m_cells[position % m_capacity].sequence.load(std::memory_order_acquire) != 2 * position + 1;
+    }
+    size_t getCapacity() const {
+        return m_capacity;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T                   item;
+    };
+
+    const size_t            m_capacity;
+    std::unique_ptr<Cell[]> m_cells;
+    std::atomic<size_t>     m_pushPosition;
+    // keeps producers and consumers on separate cache lines
+    char                    m_padding[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t>     m_popPosition;
+};
+
+}
+}
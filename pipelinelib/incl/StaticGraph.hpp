@@ -0,0 +1,154 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <initializer_list>
+#include "NodeStructure.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Input of a node in a StaticGraph: an output of an earlier node, given by their indices.
+template<size_t NodeIndex, size_t OutputIndex = 0>
+struct From {
+};
+
+// Node of a StaticGraph, of the given type, with the source of each of its inputs.
+template<typename NodeT, typename ... Sources>
+struct StaticNode {
+    using NodeType = NodeT;
+    using Inputs   = tuple<Sources...>;
+};
+
+template<typename InTup, typename OutTup>
+tuple<InTup, OutTup> getNodeTuples(const Node<InTup, OutTup>*);
+
+// The Node a node type derives from, and its input and output types.
+template<typename NodeT>
+struct StaticNodeTypes {
+    using InTup  = std::tuple_element_t<0, decltype(getNodeTuples(std::declval<const NodeT*>()))>;
+    using OutTup = std::tuple_element_t<1, decltype(getNodeTuples(std::declval<const NodeT*>()))>;
+    using Base   = Node<InTup, OutTup>;
+};
+
+constexpr bool allOf(std::initializer_list<bool> values) {
+    for (bool value : values) {
+        if (!value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// process() of the node's own type, without virtual dispatch, when it's accessible.
+template<typename NodeT>
+auto callProcess(const NodeT& node, const typename NodeT::InData& inData, int) -> decltype(node.NodeT::process(inData)) {
+    return node.NodeT::process(inData);
+}
+template<typename NodeT>
+typename NodeT::OutData callProcess(const NodeT& node, const typename NodeT::InData& inData, long) {
+    // the node's own type keeps it private, the complete object still lets compilers devirtualize
+    return static_cast<const typename StaticNodeTypes<NodeT>::Base&>(node).process(inData);
+}
+
+// A node of the graph together with its last outputs.
+template<size_t Index, typename NodeT>
+struct StaticNodeSlot {
+    StaticNodeSlot() = default;
+    template<typename ... Args>
+    explicit StaticNodeSlot(tuple<Args...>&& args) :
+        StaticNodeSlot(std::move(args), std::index_sequence_for<Args...>{})
+    {
+    }
+    template<typename ArgTup, size_t ... Indices>
+    StaticNodeSlot(ArgTup&& args, std::index_sequence<Indices...>) :
+        node(std::get<Indices>(std::move(args))...)
+    {
+    }
+
+    NodeT                   node;
+    typename NodeT::OutData outData;
+};
+
+template<typename Indices, typename ... StaticNodes>
+class StaticGraphImpl {
+};
+
+// Graph wired at compile time: every node is given with the outputs of earlier nodes feeding it,
+// so the edges are checked by the compiler, and run() evaluates the nodes in the given order as a
+// single function, calling process() directly. There's no validity tracking, every run evaluates
+// every node, and the nodes' connections and getInputHandle() are not used. The graph owns the nodes,
+// constructed from a tuple of arguments each, or default constructed.
+template<typename ... StaticNodes>
+using StaticGraph = StaticGraphImpl<std::index_sequence_for<StaticNodes...>, StaticNodes...>;
+
+template<size_t ... Indices, typename ... StaticNodes>
+class StaticGraphImpl<std::index_sequence<Indices...>, StaticNodes...> :
+    private StaticNodeSlot<Indices, typename StaticNodes::NodeType>... {
+public:
+    template<size_t Index>
+    using NodeType = typename std::tuple_element_t<Index, tuple<StaticNodes...>>::NodeType;
+    template<size_t Index, size_t OutputIndex = 0>
+    using OutType  = std::tuple_element_t<OutputIndex, typename StaticNodeTypes<NodeType<Index>>::OutTup>;
+
+    StaticGraphImpl() = default;
+    template<typename ... ArgTups, typename = std::enable_if_t<sizeof...(ArgTups) == sizeof...(StaticNodes)>>
+    explicit StaticGraphImpl(ArgTups ... args) :
+        StaticNodeSlot<Indices, typename StaticNodes::NodeType>(std::move(args))...
+    {
+    }
+    StaticGraphImpl(const StaticGraphImpl&) = delete;
+    StaticGraphImpl& operator=(const StaticGraphImpl&) = delete;
+
+    void run() {
+        using swallow = int[];
+        (void)swallow{ 0, (runNode<Indices>(typename StaticNodes::Inputs{}), 0)... };
+    }
+    template<size_t Index>
+    NodeType<Index>& getNode() {
+        return slot<Index>().node;
+    }
+    // An output of the last run.
+    template<size_t Index, size_t OutputIndex = 0>
+    const OutType<Index, OutputIndex>& get() const {
+        const auto& data = std::get<OutputIndex>(slot<Index>().outData);
+        if (data == nullptr) {
+            throw PIPELINE_EXCEPTION("No data on the output, the graph didn't run yet");
+        }
+        return *data;
+    }
+
+private:
+    template<size_t Index>
+    StaticNodeSlot<Index, NodeType<Index>>& slot() {
+        return *this;
+    }
+    template<size_t Index>
+    const StaticNodeSlot<Index, NodeType<Index>>& slot() const {
+        return *this;
+    }
+    template<size_t Index, size_t ... SourceNodes, size_t ... SourceOutputs>
+    void runNode(tuple<From<SourceNodes, SourceOutputs>...>) {
+        using InTup = typename StaticNodeTypes<NodeType<Index>>::InTup;
+        static_assert(sizeof...(SourceNodes) == std::tuple_size<InTup>::value,
+                      "Every input of a node needs exactly one source");
+        static_assert(allOf({ true, (SourceNodes < Index)... }),
+                      "Nodes can only take inputs from earlier nodes");
+        static_assert(allOf({ true, (SourceOutputs < std::tuple_size<typename StaticNodeTypes<NodeType<SourceNodes>>::OutTup>::value)... }),
+                      "The source output is overindexed");
+        runNode<Index, SourceNodes...>(std::make_index_sequence<sizeof...(SourceNodes)>{},
+                                       std::index_sequence<SourceOutputs...>{});
+    }
+    template<size_t Index, size_t ... SourceNodes, size_t ... InputIndices, size_t ... SourceOutputs>
+    void runNode(std::index_sequence<InputIndices...>, std::index_sequence<SourceOutputs...>) {
+        using InTup = typename StaticNodeTypes<NodeType<Index>>::InTup;
+        static_assert(allOf({ true, std::is_same<std::tuple_element_t<InputIndices, InTup>, OutType<SourceNodes, SourceOutputs>>::value... }),
+                      "The type of an input has to match its source output");
+        auto& current = slot<Index>();
+        current.outData = callProcess(current.node, typename NodeType<Index>::InData{ get<SourceNodes, SourceOutputs>()... }, 0);
+    }
+};
+
+}
+}
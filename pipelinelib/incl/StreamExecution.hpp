@@ -0,0 +1,54 @@
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <exception>
+#include "StreamQueue.hpp"
+#include "PipelineException.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Runs a graph on a sequence of items instead of a single value: every node the end node depends on
+// is a stage with its own thread, and every edge a bounded queue. A stage works on an item while its
+// upstream already works on the next ones, a full queue makes its producer wait. The sources have to
+// be StreamSource nodes, the stream ends once all of them were closed and their items went through.
+// Nodes only see the stream through process(), their outputs and validity are left untouched, and
+// the graph must not be modified while a stream runs.
+class StreamExecution {
+public:
+    explicit StreamExecution(NodeBase* endNode, size_t queueCapacity = 16);
+    ~StreamExecution();
+    StreamExecution(const StreamExecution&) = delete;
+    StreamExecution& operator=(const StreamExecution&) = delete;
+
+    // Next item the end node produced on the output, false at the end of the stream.
+    template<typename T>
+    bool pop(std::shared_ptr<const T>& item, size_t outputIdx = 0) {
+        auto* queue = dynamic_cast<StreamQueue<T>*>(getOutput(outputIdx));
+        if (queue == nullptr) {
+            throw PIPELINE_EXCEPTION("The type doesn't match the output");
+        }
+        return queue->pop(item);
+    }
+    // Waits for the stream to end, the end node's items that weren't popped are dropped.
+    // Rethrows the first exception of a stage, which stopped the whole stream.
+    void wait();
+    // Stops every stage without waiting for the sources to be closed.
+    void stop();
+
+private:
+    StreamQueueBase* getOutput(size_t outputIdx);
+    void             runStage (StreamStage& stage);
+
+    std::vector<std::unique_ptr<StreamStage>>     m_stages;
+    std::vector<std::unique_ptr<StreamQueueBase>> m_outputs;
+    std::vector<std::thread>                      m_threads;
+    std::mutex                                    m_errorMutex;
+    std::exception_ptr                            m_error;
+};
+
+}
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <condition_variable>
+#include "NodeBase.hpp"
+#include "RingBuffer.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Edge of a stream: the items a producing stage handed over and the consuming stage hasn't taken yet.
+class StreamQueueBase {
+public:
+    virtual ~StreamQueueBase() = default;
+    // The producer is done, the consumer gets the remaining items then the end of the stream.
+    virtual void close  () = 0;
+    // The consumer is gone: queued items are dropped and so is everything pushed from now on.
+    virtual void abandon() = 0;
+};
+
+// What a producer does when the queue of an edge is full.
+enum class Backpressure {
+    Block,          // waits for the consumer, a slow consumer throttles its producer
+    DropOldest,     // replaces the oldest queued item, the consumer sees the latest items
+    DropNewest      // drops the pushed item, the consumer sees the earliest items
+};
+
+// Options of the edge a connection makes, used when the consuming node runs in a stream.
+// Dropping policies are only accepted on nodes with a single input, whose items don't have
+// to stay paired with the items of other inputs.
+struct EdgeOptions {
+    size_t       capacity     = 0;      // items the edge queues, 0 for the stream's default
+    Backpressure backpressure = Backpressure::Block;
+};
+
+// Bounded queue on a lock-free ring buffer: pushing and popping only take a lock
+// when they have to wait, for a free slot or for an item.
+template<typename T>
+class StreamQueue : public StreamQueueBase {
+public:
+    using Item = std::shared_ptr<const T>;
+
+    explicit StreamQueue(size_t capacity, Backpressure backpressure = Backpressure::Block) :
+        m_buffer(capacity),
+        m_backpressure(backpressure),
+        m_closed(false),
+        m_abandoned(false),
+        m_waitingProducers(0),
+        m_waitingConsumers(0),
+        m_dropped(0)
+    {
+    }
+    static std::unique_ptr<StreamQueueBase> create(size_t capacity, Backpressure backpressure) {
+        return std::make_unique<StreamQueue<T>>(capacity, backpressure);
+    }
+
+    // Handles a full queue as the backpressure says, false when the queue was abandoned and
+    // the item got dropped.
+    bool push(Item item) {
+        if (m_abandoned.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (!m_buffer.tryPush(item)) {
+            switch (m_backpressure) {
+            case Backpressure::Block:
+                if (!waitToPush(item)) {
+                    return false;
+                }
+                break;
+            case Backpressure::DropOldest: {
+                Item oldest;
+                while (!m_buffer.tryPush(item)) {
+                    if (m_buffer.tryPop(oldest)) {
+                        m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                break;
+            }
+            case Backpressure::DropNewest:
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        wake(m_waitingConsumers, m_notEmpty);
+        return true;
+    }
+    // Blocks while the queue is empty, false at the end of the stream.
+    bool pop(Item& item) {
+        if (!m_buffer.tryPop(item) && !waitToPop(item)) {
+            return false;
+        }
+        wake(m_waitingProducers, m_notFull);
+        return true;
+    }
+    // Doesn't wait, false while the queue is empty.
+    bool tryPop(Item& item) {
+        if (!m_buffer.tryPop(item)) {
+            return false;
+        }
+        wake(m_waitingProducers, m_notFull);
+        return true;
+    }
+    // Whether no item is queued. An item found is kept for the consumer, unless the producer
+    // drops the oldest items.
+    bool isEmpty() const {
+        return m_buffer.isEmpty();
+    }
+    // Items dropped because the queue was full.
+    size_t getDroppedCount() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+    bool isAbandoned() const {
+        return m_abandoned.load(std::memory_order_acquire);
+    }
+    // Makes the queue usable again, only while no one is using it.
+    void reset() {
+        Item item;
+        while (m_buffer.tryPop(item)) {
+        }
+        m_closed.store(false, std::memory_order_relaxed);
+        m_abandoned.store(false, std::memory_order_relaxed);
+        m_dropped.store(0, std::memory_order_relaxed);
+    }
+    void close() override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed.store(true, std::memory_order_release);
+        }
+        m_notEmpty.notify_all();
+    }
+    void abandon() override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed.store(true, std::memory_order_release);
+            m_abandoned.store(true, std::memory_order_release);
+        }
+        Item item;
+        while (m_buffer.tryPop(item)) {
+        }
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+private:
+    // A waiting thread registers itself then retries under the lock, the other side checks for
+    // waiting threads after its own operation: one of them always sees the other.
+    bool waitToPush(Item& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_waitingProducers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool pushed;
+        while (!(pushed = m_buffer.tryPush(item)) && !m_abandoned.load(std::memory_order_relaxed)) {
+            m_notFull.wait(lock);
+        }
+        m_waitingProducers.fetch_sub(1, std::memory_order_relaxed);
+        return pushed;
+    }
+    bool waitToPop(Item& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_waitingConsumers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool popped;
+        while (!(popped = m_buffer.tryPop(item)) && !m_closed.load(std::memory_order_acquire)) {
+            m_notEmpty.wait(lock);
+        }
+        // items pushed right before closing
+        if (!popped) {
+            popped = m_buffer.tryPop(item);
+        }
+        m_waitingConsumers.fetch_sub(1, std::memory_order_relaxed);
+        return popped;
+    }
+    void wake(const std::atomic<size_t>& waiting, std::condition_variable& condition) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            condition.notify_all();
+        }
+    }
+
+    RingBuffer<Item>        m_buffer;
+    const Backpressure      m_backpressure;
+    std::atomic<bool>       m_closed;
+    std::atomic<bool>       m_abandoned;
+    std::atomic<size_t>     m_waitingProducers;
+    std::atomic<size_t>     m_waitingConsumers;
+    std::atomic<size_t>     m_dropped;
+    std::mutex              m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
+
+// A node running as one stage of a stream: it takes an item from each of its input queues,
+// and pushes what it produces to the queues subscribed to its outputs.
+class StreamStage {
+public:
+    virtual ~StreamStage() = default;
+
+    virtual size_t             getInputCount () const = 0;
+    virtual StreamQueueBase&   getInput      (size_t inputIdx) = 0;
+    // The output of another node feeding the input.
+    virtual const OutConnBase* getInputSource(size_t inputIdx) const = 0;
+    virtual size_t             getOutputCount() const = 0;
+    // A queue holding the items of the given output.
+    virtual std::unique_ptr<StreamQueueBase> createQueue(size_t outputIdx, size_t capacity,
+                                                         Backpressure backpressure) const = 0;
+    // The queue gets the items produced on the output, which must belong to the stage's node.
+    virtual void               subscribe     (const OutConnBase* output, StreamQueueBase& queue) = 0;
+    // Processes the next items, false once an input's stream ended.
+    virtual bool               step          () = 0;
+    // Ends the stream of every subscribed queue, and drops the queued and upcoming input items so the
+    // producers don't wait for the stage anymore. From any thread, which stops the stage early.
+    virtual void               close         () = 0;
+};
+
+}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "NodeStructure.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Starts a stream with the items pushed to it, see StreamExecution. Items can be pushed before the
+// stream starts; once a stream ended, pushing fails until the next one starts.
+template<typename T>
+class StreamSource : public Node<tuple<>, tuple<T>> {
+public:
+    using OutData = typename Node<tuple<>, tuple<T>>::OutData;
+
+    // The backpressure applies to the pushes of the source's feed.
+    explicit StreamSource(size_t capacity = 16, Backpressure backpressure = Backpressure::Block) :
+        m_feed(capacity, backpressure)
+    {
+    }
+    // Blocks while the feed is full, false when the stream stopped and the item got dropped.
+    bool push(T item) {
+        return m_feed.push(std::make_shared<const T>(std::move(item)));
+    }
+    bool push(shared_ptr<const T> item) {
+        return m_feed.push(std::move(item));
+    }
+    // Items pushed while the feed was full and that got dropped for that.
+    size_t getDroppedCount() const {
+        return m_feed.getDroppedCount();
+    }
+    // Ends the stream once the pushed items went through.
+    void close() {
+        m_feed.close();
+    }
+    OutData process(const tuple<>&) const override {
+        throw PIPELINE_EXCEPTION("Stream sources only produce items in a stream");
+    }
+    unique_ptr<StreamStage> createStreamStage(size_t) override {
+        if (m_feed.isAbandoned()) {
+            m_feed.reset();
+        }
+        return std::make_unique<Stage>(*this);
+    }
+
+private:
+    class Stage : public StreamStage {
+    public:
+        explicit Stage(StreamSource& source) : m_source(source)
+        {
+        }
+        size_t getInputCount() const override {
+            return 0;
+        }
+        StreamQueueBase& getInput(size_t) override {
+            throw PIPELINE_EXCEPTION("Input overindexed");
+        }
+        const OutConnBase* getInputSource(size_t) const override {
+            throw PIPELINE_EXCEPTION("Input overindexed");
+        }
+        size_t getOutputCount() const override {
+            return 1;
+        }
+        unique_ptr<StreamQueueBase> createQueue(size_t outputIdx, size_t capacity, Backpressure backpressure) const override {
+            return StreamOutputs<tuple<T>>::createQueue(outputIdx, capacity, backpressure);
+        }
+        void subscribe(const OutConnBase* output, StreamQueueBase& queue) override {
+            if (m_source.getOutConn(0) != output) {
+                throw PIPELINE_EXCEPTION("The output doesn't belong to the node");
+            }
+            m_outputs.subscribe(0, queue);
+        }
+        bool step() override {
+            shared_ptr<const T> item;
+            if (!m_source.m_feed.pop(item)) {
+                return false;
+            }
+            m_outputs.template push<0>(std::move(item));
+            return true;
+        }
+        void close() override {
+            m_source.m_feed.abandon();
+            m_outputs.close();
+        }
+
+    private:
+        StreamSource&           m_source;
+        StreamOutputs<tuple<T>> m_outputs;
+    };
+
+    StreamQueue<T> m_feed;
+};
+
+}
+}
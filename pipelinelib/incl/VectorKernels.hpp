@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mfep {
+namespace Pipeline {
+
+// Instruction sets the kernels come in, each one wider than the previous.
+enum class SimdLevel {
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+// The widest level the CPU runs, detected once.
+SimdLevel getSupportedSimdLevel();
+// The level the kernels use, the supported one unless it was set lower.
+SimdLevel getSimdLevel         ();
+void      setSimdLevel         (SimdLevel level);
+
+// Item by item over count items, the output may be one of the inputs. Integers wrap around on overflow.
+void    vectorAdd     (const int32_t* lhs, const int32_t* rhs, int32_t* out, size_t count);
+void    vectorAdd     (const float*   lhs, const float*   rhs, float*   out, size_t count);
+void    vectorMultiply(const int32_t* lhs, const int32_t* rhs, int32_t* out, size_t count);
+void    vectorMultiply(const float*   lhs, const float*   rhs, float*   out, size_t count);
+void    vectorConvert (const int32_t* in, float* out, size_t count);
+// Vectorized float sums add the items in a different order, so they may round differently.
+int32_t vectorSum     (const int32_t* in, size_t count);
+float   vectorSum     (const float*   in, size_t count);
+
+}
+}
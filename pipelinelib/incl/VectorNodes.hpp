@@ -0,0 +1,106 @@
+#pragma once
+
+#include "BatchNode.hpp"
+#include "VectorKernels.hpp"
+#include "AlignedAllocator.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Item by item kernels of VectorKernels, for the nodes below.
+struct AddKernel {
+    template<typename T>
+    static void apply(const T* lhs, const T* rhs, T* out, size_t count) {
+        vectorAdd(lhs, rhs, out, count);
+    }
+};
+struct MultiplyKernel {
+    template<typename T>
+    static void apply(const T* lhs, const T* rhs, T* out, size_t count) {
+        vectorMultiply(lhs, rhs, out, count);
+    }
+};
+
+// Combines two items with a vectorized kernel, which runs over whole batches in a stream.
+template<typename T, typename Kernel>
+class VectorBinaryNode : public BatchNode<tuple<T, T>, tuple<T>> {
+public:
+    using InBatch  = typename BatchNode<tuple<T, T>, tuple<T>>::InBatch;
+    using OutBatch = typename BatchNode<tuple<T, T>, tuple<T>>::OutBatch;
+
+    void processBatch(const InBatch& inBatch, const OutBatch& outBatch) const override {
+        const auto& out = std::get<0>(outBatch);
+        Kernel::apply(std::get<0>(inBatch).data(), std::get<1>(inBatch).data(), out.data(), out.size());
+    }
+};
+template<typename T>
+using VectorAddNode = VectorBinaryNode<T, AddKernel>;
+template<typename T>
+using VectorMultiplyNode = VectorBinaryNode<T, MultiplyKernel>;
+
+template<typename From, typename To>
+class VectorConvertNode : public BatchNode<tuple<From>, tuple<To>> {
+public:
+    using InBatch  = typename BatchNode<tuple<From>, tuple<To>>::InBatch;
+    using OutBatch = typename BatchNode<tuple<From>, tuple<To>>::OutBatch;
+
+    void processBatch(const InBatch& inBatch, const OutBatch& outBatch) const override {
+        const auto& out = std::get<0>(outBatch);
+        vectorConvert(std::get<0>(inBatch).data(), out.data(), out.size());
+    }
+};
+
+// Combines two whole columns item by item, they have to be the same size.
+template<typename T, typename Kernel>
+class ColumnBinaryNode : public Node<tuple<Column<T>, Column<T>>, tuple<Column<T>>> {
+public:
+    using InData  = typename Node<tuple<Column<T>, Column<T>>, tuple<Column<T>>>::InData;
+    using OutData = typename Node<tuple<Column<T>, Column<T>>, tuple<Column<T>>>::OutData;
+
+    OutData process(const InData& inData) const override {
+        const Column<T>& lhs = std::get<0>(inData);
+        const Column<T>& rhs = std::get<1>(inData);
+        if (lhs.size() != rhs.size()) {
+            throw PIPELINE_EXCEPTION("Columns must have the same size");
+        }
+        auto out = this->template acquireOutputBuffer<0>();
+        out->resize(lhs.size());
+        Kernel::apply(lhs.data(), rhs.data(), out->data(), lhs.size());
+        return OutData{ std::move(out) };
+    }
+};
+template<typename T>
+using ColumnAddNode = ColumnBinaryNode<T, AddKernel>;
+template<typename T>
+using ColumnMultiplyNode = ColumnBinaryNode<T, MultiplyKernel>;
+
+template<typename From, typename To>
+class ColumnConvertNode : public Node<tuple<Column<From>>, tuple<Column<To>>> {
+public:
+    using InData  = typename Node<tuple<Column<From>>, tuple<Column<To>>>::InData;
+    using OutData = typename Node<tuple<Column<From>>, tuple<Column<To>>>::OutData;
+
+    OutData process(const InData& inData) const override {
+        const Column<From>& in = std::get<0>(inData);
+        auto out = this->template acquireOutputBuffer<0>();
+        out->resize(in.size());
+        vectorConvert(in.data(), out->data(), in.size());
+        return OutData{ std::move(out) };
+    }
+};
+
+// Adds up every item of a column.
+template<typename T>
+class ColumnSumNode : public Node<tuple<Column<T>>, tuple<T>> {
+public:
+    using InData  = typename Node<tuple<Column<T>>, tuple<T>>::InData;
+    using OutData = typename Node<tuple<Column<T>>, tuple<T>>::OutData;
+
+    OutData process(const InData& inData) const override {
+        const Column<T>& in = std::get<0>(inData);
+        return OutData{ std::make_unique<T>(vectorSum(in.data(), in.size())) };
+    }
+};
+
+}
+}
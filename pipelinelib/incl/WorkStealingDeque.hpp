@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+namespace mfep {
+namespace Pipeline {
+
+// Chase-Lev deque: the owning thread pushes and pops at the bottom without contention,
+// while any other thread may steal from the top. The buffer grows on demand, retired
+// buffers are kept until destruction as thieves may still be reading them.
+template<typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "Deque items are copied through atomics");
+
+public:
+    explicit WorkStealingDeque(size_t capacity = 64) :
+        m_top(0),
+        m_bottom(0)
+    {
+        m_buffers.push_back(std::make_unique<Buffer>(roundToPowerOfTwo(capacity)));
+        m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // owner only
+    void push(T item) {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        if (bottom - top >= static_cast<int64_t>(buffer->capacity)) {
+            buffer = grow(buffer, top, bottom);
+        }
+        buffer->put(bottom, item);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+    // owner only, takes the most recently pushed item
+    bool pop(T& item) {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        item = buffer->get(bottom);
+        if (top == bottom) {
+            // the last item, raced for with the thieves
+            const bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                           std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+    // any thread, takes the least recently pushed item
+    bool steal(T& item) {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return false;
+        }
+        item = m_buffer.load(std::memory_order_acquire)->get(top);
+        return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+    bool empty() const {
+        return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Buffer {
+        explicit Buffer(size_t _capacity) :
+            capacity(_capacity),
+            items(new std::atomic<T>[_capacity])
+        {
+        }
+        T get(int64_t index) const {
+            return items[static_cast<size_t>(index) & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+        void put(int64_t index, T item) {
+            items[static_cast<size_t>(index) & (capacity - 1)].store(item, std::memory_order_relaxed);
+        }
+
+        const size_t                      capacity;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    static size_t roundToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result *= 2;
+        }
+        return result;
+    }
+    Buffer* grow(const Buffer* buffer, int64_t top, int64_t bottom) {
+        m_buffers.push_back(std::make_unique<Buffer>(buffer->capacity * 2));
+        Buffer* grown = m_buffers.back().get();
+        for (int64_t i = top; i < bottom; ++i) {
+            grown->put(i, buffer->get(i));
+        }
+        m_buffer.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+    std::atomic<int64_t>                 m_top;
+    std::atomic<int64_t>                 m_bottom;
+    std::atomic<Buffer*>                 m_buffer;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
+
+}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include "WorkStealingDeque.hpp"
+
+namespace mfep {
+namespace Pipeline {
+
+// Runs jobs made of fine-grained tasks. Every worker has its own deque: tasks spawned while
+// running a task stay on the worker that spawned them, and idle workers steal from the others.
+class WorkStealingPool {
+public:
+    // Runs a task on the given worker; tasks are indices whose meaning is up to the job.
+    using TaskRunner = std::function<void(size_t task, size_t worker)>;
+
+    explicit WorkStealingPool(size_t threadCount);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Starts running the tasks and everything they spawn, in the background: once all of them finished,
+    // onFinished is called on the worker that finished last, or right away when there are no tasks.
+    // Initial tasks are started in the given order. The runner must not throw, and must be kept
+    // alive until the job finished. Only one job runs at a time.
+    void   start         (const TaskRunner& runner, const std::vector<size_t>& tasks, std::function<void()> onFinished);
+    // Runs the tasks like start(), but returns only once all of them finished.
+    void   run           (const TaskRunner& runner, const std::vector<size_t>& tasks);
+    // Only from a task running on the worker.
+    void   spawn         (size_t worker, size_t task);
+    // Keeps the job running while a task waits for something outside of the pool, only from a task
+    // running on a worker. Every suspend() is paired with one resume(), from any thread, of the task
+    // to run once the wait is over.
+    void   suspend       ();
+    void   resume        (size_t task);
+    size_t getThreadCount() const;
+
+private:
+    struct Worker {
+        WorkStealingDeque<size_t> deque;
+    };
+
+    void workerLoop(size_t worker);
+    void work      (size_t worker);
+    bool findTask  (size_t worker, size_t& task);
+    bool hasWork   () const;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread>             m_threads;
+    // the current job, only modified while no worker runs one
+    const TaskRunner*                    m_runner;
+    std::function<void()>                m_onFinished;
+    std::vector<size_t>                  m_initialTasks;
+    std::atomic<size_t>                  m_nextInitialTask;
+    // resumed tasks, guarded by the mutex
+    std::vector<size_t>                  m_resumedTasks;
+    std::atomic<size_t>                  m_resumedCount;
+    // spawned and not finished tasks of the current job
+    std::atomic<size_t>                  m_outstanding;
+    std::atomic<size_t>                  m_sleeping;
+    std::mutex                           m_mutex;
+    std::condition_variable              m_jobStarted;
+    std::condition_variable              m_workAvailable;
+    std::condition_variable              m_jobFinished;
+    size_t                               m_generation;
+    size_t                               m_activeWorkers;
+    bool                                 m_stopping;
+};
+
+}
+}
@@ -0,0 +1,33 @@
+#include <cstdint>
+#include <algorithm>
+#include "Arena.hpp"
+#include "PipelineException.hpp"
+
+using namespace mfep::Pipeline;
+
+Arena::Arena(size_t blockSize) :
+    m_blockSize(blockSize),
+    m_current(nullptr),
+    m_remaining(0)
+{
+    if (blockSize == 0) {
+        throw PIPELINE_EXCEPTION("Arena block size cannot be zero");
+    }
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    auto address = reinterpret_cast<std::uintptr_t>(m_current);
+    size_t padding = (alignment - address % alignment) % alignment;
+    if (m_current == nullptr || padding + size > m_remaining) {
+        const size_t newBlockSize = std::max(m_blockSize, size + alignment);
+        m_blocks.emplace_back(new unsigned char[newBlockSize]);
+        m_current = m_blocks.back().get();
+        m_remaining = newBlockSize;
+        address = reinterpret_cast<std::uintptr_t>(m_current);
+        padding = (alignment - address % alignment) % alignment;
+    }
+    void* retval = m_current + padding;
+    m_current += padding + size;
+    m_remaining -= padding + size;
+    return retval;
+}
@@ -0,0 +1,64 @@
+#include "ExecutionHandle.hpp"
+#include "PipelineException.hpp"
+
+using namespace mfep::Pipeline;
+
+ExecutionHandle::ExecutionHandle(std::shared_ptr<State> state) :
+    m_state(std::move(state))
+{
+}
+
+ExecutionHandle::Status ExecutionHandle::getStatus() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->status;
+}
+
+bool ExecutionHandle::isDone() const {
+    return getStatus() != Status::Running;
+}
+
+void ExecutionHandle::wait() const {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->done.wait(lock, [this]{ return m_state->status != Status::Running; });
+}
+
+void ExecutionHandle::get() const {
+    wait();
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if (m_state->status == Status::Failed) {
+        std::rethrow_exception(m_state->error);
+    }
+    if (m_state->status == Status::Cancelled) {
+        throw PIPELINE_EXCEPTION("The execution was cancelled");
+    }
+}
+
+void ExecutionHandle::cancel() {
+    m_state->cancelRequested.store(true, std::memory_order_relaxed);
+}
+
+void ExecutionHandle::onComplete(Callback callback) {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    if (m_state->status == Status::Running) {
+        m_state->callbacks.push_back(std::move(callback));
+        return;
+    }
+    const Status status = m_state->status;
+    lock.unlock();
+    callback(status);
+}
+
+void ExecutionHandle::State::complete(Status result, std::exception_ptr exception) {
+    // the execution is done before the callbacks run, so they can wait for it and start the next one
+    std::vector<Callback> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        status = result;
+        error = std::move(exception);
+        pending.swap(callbacks);
+    }
+    done.notify_all();
+    for (auto& callback : pending) {
+        callback(result);
+    }
+}
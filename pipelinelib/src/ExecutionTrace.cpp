@@ -0,0 +1,124 @@
+#include <memory>
+#include <cstdlib>
+#include <typeinfo>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+#include "ExecutionTrace.hpp"
+#include "NodeBase.hpp"
+
+using namespace mfep::Pipeline;
+
+namespace {
+
+std::string getTypeName(const NodeBase& node) {
+    const char* name = typeid(node).name();
+#ifdef __GNUG__
+    int status = 0;
+    std::unique_ptr<char, void(*)(void*)> demangled(abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+    if (status == 0) {
+        return demangled.get();
+    }
+#endif
+    return name;
+}
+
+void writeString(std::ostream& stream, const std::string& string) {
+    stream << '"';
+    for (const char c : string) {
+        switch (c) {
+            case '"':  stream << "\\\""; break;
+            case '\\': stream << "\\\\"; break;
+            case '\n': stream << "\\n"; break;
+            case '\t': stream << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    stream << ' ';
+                } else {
+                    stream << c;
+                }
+        }
+    }
+    stream << '"';
+}
+
+}
+
+ExecutionTrace::ExecutionTrace() :
+    m_origin(Clock::now()),
+    m_execution(0)
+{
+}
+
+void ExecutionTrace::beginExecution() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_execution;
+}
+
+void ExecutionTrace::record(const NodeBase* node, Clock::time_point begin, Clock::time_point end) {
+    const std::vector<NodeBase*> inputNodes = node->getInputNodes();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t spanIndex = m_spans.size();
+    const auto inserted = m_nodeIndices.emplace(node, m_nodeInfos.size());
+    if (inserted.second) {
+        const std::string type = getTypeName(*node);
+        m_nodeInfos.push_back(NodeInfo{ node->getName().empty() ? type : node->getName(), type, spanIndex, m_execution });
+    }
+    // inputs evaluated in this execution finished before the node started, so their latest span is the producer
+    for (auto* inputNode : inputNodes) {
+        const auto it = m_nodeIndices.find(inputNode);
+        if (it != m_nodeIndices.end() && m_nodeInfos[it->second].lastExecution == m_execution) {
+            m_flows.push_back(Flow{ m_nodeInfos[it->second].lastSpan, spanIndex });
+        }
+    }
+    m_nodeInfos[inserted.first->second].lastSpan = spanIndex;
+    m_nodeInfos[inserted.first->second].lastExecution = m_execution;
+    m_spans.push_back(Span{ inserted.first->second, std::this_thread::get_id(), toMicroseconds(begin), toMicroseconds(end) });
+}
+
+void ExecutionTrace::write(std::ostream& stream) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<std::thread::id, size_t> threadIndices;
+    std::vector<size_t> spanThreads;
+    spanThreads.reserve(m_spans.size());
+    for (const auto& span : m_spans) {
+        spanThreads.push_back(threadIndices.emplace(span.thread, threadIndices.size()).first->second);
+    }
+
+    const auto flags = stream.flags(std::ios::fixed);
+    const auto precision = stream.precision(3);
+    const char* separator = "\n";
+    stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (const auto& thread : threadIndices) {
+        stream << separator << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << thread.second
+               << R"(,"args":{"name":"thread )" << thread.second << "\"}}";
+        separator = ",\n";
+    }
+    for (size_t i = 0; i < m_spans.size(); ++i) {
+        const Span& span = m_spans[i];
+        const NodeInfo& info = m_nodeInfos[span.node];
+        stream << separator << R"({"name":)";
+        writeString(stream, info.name);
+        stream << R"(,"cat":"evaluate","ph":"X","pid":1,"tid":)" << spanThreads[i]
+               << ",\"ts\":" << span.begin << ",\"dur\":" << span.end - span.begin << R"(,"args":{"type":)";
+        writeString(stream, info.type);
+        stream << "}}";
+        separator = ",\n";
+    }
+    for (size_t i = 0; i < m_flows.size(); ++i) {
+        // flow events bind to the span enclosing their timestamp
+        const Span& from = m_spans[m_flows[i].from];
+        const Span& to = m_spans[m_flows[i].to];
+        stream << separator << R"({"name":"edge","cat":"edge","ph":"s","id":)" << i
+               << ",\"pid\":1,\"tid\":" << spanThreads[m_flows[i].from] << ",\"ts\":" << from.begin << "},\n"
+               << R"({"name":"edge","cat":"edge","ph":"f","bp":"e","id":)" << i
+               << ",\"pid\":1,\"tid\":" << spanThreads[m_flows[i].to] << ",\"ts\":" << to.begin << "}";
+    }
+    stream << "\n]}\n";
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+double ExecutionTrace::toMicroseconds(Clock::time_point time) const {
+    return std::chrono::duration<double, std::micro>(time - m_origin).count();
+}
@@ -0,0 +1,57 @@
+#include <algorithm>
+#include "InvalidationBatch.hpp"
+
+using namespace mfep::Pipeline;
+
+namespace {
+
+struct PropagationState {
+    std::vector<NodeBase*> worklist;
+    size_t                 depth = 0;
+};
+
+// graph modifications are single threaded, every thread propagates its own changes
+thread_local PropagationState propagationState;
+
+}
+
+InvalidationBatch::InvalidationBatch() {
+    ++propagationState.depth;
+}
+
+InvalidationBatch::~InvalidationBatch() {
+    --propagationState.depth;
+    if (propagationState.depth == 0) {
+        drain();
+    }
+}
+
+bool InvalidationBatch::isActive() {
+    return propagationState.depth > 0;
+}
+
+void InvalidationBatch::schedule(NodeBase* node) {
+    PropagationState& state = propagationState;
+    state.worklist.push_back(node);
+    if (state.depth == 0) {
+        drain();
+    }
+}
+
+void InvalidationBatch::forget(const NodeBase* node) {
+    auto& worklist = propagationState.worklist;
+    worklist.erase(std::remove(worklist.begin(), worklist.end(), node), worklist.end());
+}
+
+void InvalidationBatch::drain() {
+    struct DepthGuard {
+        DepthGuard() { ++propagationState.depth; }
+        ~DepthGuard() { --propagationState.depth; }
+    } guard;
+    auto& worklist = propagationState.worklist;
+    while (!worklist.empty()) {
+        NodeBase* node = worklist.back();
+        worklist.pop_back();
+        node->notifyChanged();
+    }
+}
@@ -1,15 +1,72 @@
+#include <atomic>
+#include <vector>
+#include <unordered_set>
 #include "NodeAlgorithms.hpp"
 #include "PipelineException.hpp"
 
+namespace {
+
+std::atomic<size_t> topologyRevision { 0 };
+
+struct VisitFrame {
+    mfep::Pipeline::NodeBase*              node;
+    std::vector<mfep::Pipeline::NodeBase*> inputNodes;
+    size_t                                 nextInput;
+};
+
+}
+
 bool mfep::Pipeline::isDependentOn(const mfep::Pipeline::NodeBase* node,
                                    const mfep::Pipeline::NodeBase* dependentNode) {
-    for (const NodeBase* n : dependentNode->getInputNodes()) {
-        if (n == node) {
-            return true;
-        }
-        if (isDependentOn(node, n)) {
-            return true;
+    // every path from node to dependentNode climbs the topological order, so only
+    // the nodes ordered between the two can be on it
+    const size_t upperBound = dependentNode->getTopologicalOrder();
+    if (node->getTopologicalOrder() >= upperBound) {
+        return false;
+    }
+    std::unordered_set<const NodeBase*> visited { node };
+    std::vector<const NodeBase*> stack { node };
+    while (!stack.empty()) {
+        const NodeBase* current = stack.back();
+        stack.pop_back();
+        for (const NodeBase* outputNode : current->getOutputNodes()) {
+            if (outputNode == dependentNode) {
+                return true;
+            }
+            if (outputNode->getTopologicalOrder() < upperBound && visited.insert(outputNode).second) {
+                stack.push_back(outputNode);
+            }
         }
     }
     return false;
 }
+
+// Iterative post-order DFS: every node reachable from endNode appears exactly once,
+// after all of its inputs. Runs in O(V+E) without recursing on the graph depth.
+std::vector<mfep::Pipeline::NodeBase*> mfep::Pipeline::collectExecutionOrder(mfep::Pipeline::NodeBase* endNode) {
+    std::vector<NodeBase*> order;
+    std::unordered_set<NodeBase*> visited { endNode };
+    std::vector<VisitFrame> stack;
+    stack.push_back(VisitFrame{ endNode, endNode->getInputNodes(), 0 });
+    while (!stack.empty()) {
+        VisitFrame& frame = stack.back();
+        if (frame.nextInput < frame.inputNodes.size()) {
+            auto* inputNode = frame.inputNodes[frame.nextInput++];
+            if (visited.insert(inputNode).second) {
+                stack.push_back(VisitFrame{ inputNode, inputNode->getInputNodes(), 0 });
+            }
+        } else {
+            order.push_back(frame.node);
+            stack.pop_back();
+        }
+    }
+    return order;
+}
+
+size_t mfep::Pipeline::getTopologyRevision() {
+    return topologyRevision.load();
+}
+
+void mfep::Pipeline::topologyChanged() {
+    ++topologyRevision;
+}
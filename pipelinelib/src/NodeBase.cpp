@@ -0,0 +1,201 @@
+#include <atomic>
+#include <algorithm>
+#include "NodeBase.hpp"
+#include "StreamQueue.hpp"
+#include "InvalidationBatch.hpp"
+#include "PipelineException.hpp"
+
+using namespace mfep::Pipeline;
+
+namespace {
+
+std::atomic<size_t> nextTopologicalOrder { 0 };
+
+void eraseOne(std::vector<NodeBase*>& nodes, const NodeBase* node) {
+    const auto it = std::find(nodes.begin(), nodes.end(), node);
+    if (it != nodes.end()) {
+        *it = nodes.back();
+        nodes.pop_back();
+    }
+}
+
+bool compareOrder(const NodeBase* lhs, const NodeBase* rhs) {
+    return lhs->getTopologicalOrder() < rhs->getTopologicalOrder();
+}
+
+}
+
+NodeBase::NodeBase() :
+    m_topologicalOrder(nextTopologicalOrder++),
+    m_edgeRevision(0),
+    m_visited(false)
+{
+}
+
+NodeBase::~NodeBase() {
+    if (InvalidationBatch::isActive()) {
+        InvalidationBatch::forget(this);
+    }
+    for (auto* inputNode : m_inputEdges) {
+        eraseOne(inputNode->m_outputNodes, this);
+        ++inputNode->m_edgeRevision;
+    }
+    for (auto* outputNode : m_outputNodes) {
+        eraseOne(outputNode->m_inputEdges, this);
+        ++outputNode->m_edgeRevision;
+    }
+}
+
+bool NodeBase::isAsynchronous() const {
+    return false;
+}
+
+void NodeBase::evaluateAsync(EvaluationCallback done) {
+    try {
+        evaluate();
+    } catch (...) {
+        done(std::current_exception());
+        return;
+    }
+    done(nullptr);
+}
+
+std::unique_ptr<StreamStage> NodeBase::createStreamStage(size_t) {
+    throw PIPELINE_EXCEPTION("The node cannot run in a stream");
+}
+
+bool NodeBase::isFusible() const {
+    return false;
+}
+
+const void* NodeBase::evaluateFused(const void*, bool) {
+    throw PIPELINE_EXCEPTION("The node cannot be fused");
+}
+
+bool NodeBase::isOutputElided() const {
+    return false;
+}
+
+const std::vector<NodeBase*>& NodeBase::getOutputNodes() const {
+    return m_outputNodes;
+}
+
+size_t NodeBase::getTopologicalOrder() const {
+    return m_topologicalOrder;
+}
+
+size_t NodeBase::getEdgeRevision() const {
+    return m_edgeRevision;
+}
+
+void NodeBase::enableProfiling(bool enabled) {
+    if (!enabled) {
+        m_profile.reset();
+    } else if (m_profile == nullptr) {
+        m_profile = std::make_unique<NodeProfile>();
+    }
+}
+
+const std::string& NodeBase::getName() const {
+    return m_name;
+}
+
+void NodeBase::setName(std::string name) {
+    m_name = std::move(name);
+}
+
+void NodeBase::notifyChanged() const {
+    changed();
+}
+
+void NodeBase::addInputEdge(NodeBase& inputNode) {
+    if (&inputNode == this) {
+        throw PIPELINE_EXCEPTION("Cannot connect: output node is dependent on input node");
+    }
+    if (inputNode.m_topologicalOrder > m_topologicalOrder) {
+        reorder(inputNode);
+    }
+    inputNode.m_outputNodes.push_back(this);
+    m_inputEdges.push_back(&inputNode);
+    ++inputNode.m_edgeRevision;
+    ++m_edgeRevision;
+}
+
+void NodeBase::removeInputEdge(NodeBase& inputNode) {
+    eraseOne(inputNode.m_outputNodes, this);
+    eraseOne(m_inputEdges, &inputNode);
+    ++inputNode.m_edgeRevision;
+    ++m_edgeRevision;
+}
+
+// Pearce-Kelly: only the nodes whose order lies between the two endpoints of the
+// new edge are visited, and their existing order labels are redistributed among them.
+void NodeBase::reorder(NodeBase& inputNode) {
+    const size_t lowerBound = m_topologicalOrder;
+    const size_t upperBound = inputNode.m_topologicalOrder;
+    std::vector<NodeBase*> forward, backward, stack;
+
+    const auto clearMarks = [&forward, &backward]{
+        for (auto* node : forward) {
+            node->m_visited = false;
+        }
+        for (auto* node : backward) {
+            node->m_visited = false;
+        }
+    };
+
+    m_visited = true;
+    stack.push_back(this);
+    while (!stack.empty()) {
+        NodeBase* node = stack.back();
+        stack.pop_back();
+        forward.push_back(node);
+        for (auto* outputNode : node->m_outputNodes) {
+            if (outputNode == &inputNode) {
+                clearMarks();
+                for (auto* pending : stack) {
+                    pending->m_visited = false;
+                }
+                throw PIPELINE_EXCEPTION("Cannot connect: output node is dependent on input node");
+            }
+            if (!outputNode->m_visited && outputNode->m_topologicalOrder < upperBound) {
+                outputNode->m_visited = true;
+                stack.push_back(outputNode);
+            }
+        }
+    }
+
+    inputNode.m_visited = true;
+    stack.push_back(&inputNode);
+    while (!stack.empty()) {
+        NodeBase* node = stack.back();
+        stack.pop_back();
+        backward.push_back(node);
+        for (auto* inputEdge : node->m_inputEdges) {
+            if (!inputEdge->m_visited && inputEdge->m_topologicalOrder > lowerBound) {
+                inputEdge->m_visited = true;
+                stack.push_back(inputEdge);
+            }
+        }
+    }
+    clearMarks();
+
+    std::sort(forward.begin(), forward.end(), compareOrder);
+    std::sort(backward.begin(), backward.end(), compareOrder);
+    std::vector<size_t> orders;
+    orders.reserve(forward.size() + backward.size());
+    for (auto* node : backward) {
+        orders.push_back(node->m_topologicalOrder);
+    }
+    for (auto* node : forward) {
+        orders.push_back(node->m_topologicalOrder);
+    }
+    std::sort(orders.begin(), orders.end());
+    size_t i = 0;
+    for (auto* node : backward) {
+        node->m_topologicalOrder = orders[i++];
+    }
+    for (auto* node : forward) {
+        node->m_topologicalOrder = orders[i++];
+    }
+}
@@ -1,26 +1,612 @@
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <numeric>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <exception>
 #include "NodeExecution.hpp"
+#include "NodeAlgorithms.hpp"
+#include "InvalidationBatch.hpp"
+#include "WorkStealingPool.hpp"
 
 using namespace mfep::Pipeline;
 
 namespace {
 
-std::vector<NodeBase*> collectInputNodesToEvaluate(NodeBase* node) {
-    std::vector<NodeBase*> retval { node };
-    for (auto* inputNode : node->getInputNodes()) {
-        retval.push_back(inputNode);
-        const auto inputNodes = collectInputNodesToEvaluate(inputNode);
-        retval.insert(retval.end(), inputNodes.begin(), inputNodes.end());
+// A valid node the walk stops at serves its output without being evaluated.
+void countCacheHit(const NodeBase* node) {
+    if (auto* profile = node->getProfile()) {
+        ++profile->cacheHits;
     }
-    return retval;
 }
 
+using Clock = std::chrono::steady_clock;
+
+// Weight of the latest measurement in a node's cost, older ones fade out exponentially.
+constexpr double CostSmoothing = 0.25;
+// Reading the clock is not free compared to light nodes, so costs are only measured on every
+// few executions of a plan, besides the first evaluation of each node.
+constexpr size_t CostSamplingPeriod = 8;
+
+// Runs the evaluation of the node, and folds the time it took into its cost when sampling.
+template<typename Evaluation>
+void measureEvaluation(NodeBase* node, double& cost, bool sampling, ExecutionTrace* trace, Evaluation evaluation) {
+    const bool measureCost = sampling || cost == 0.0;
+    if (!measureCost && trace == nullptr) {
+        evaluation();
+        return;
+    }
+    const auto begin = Clock::now();
+    try {
+        evaluation();
+    } catch (...) {
+        if (trace != nullptr) {
+            trace->record(node, begin, Clock::now());
+        }
+        throw;
+    }
+    const auto end = Clock::now();
+    if (measureCost) {
+        const double duration = std::chrono::duration<double, std::nano>(end - begin).count();
+        cost = cost == 0.0 ? duration : cost + CostSmoothing * (duration - cost);
+    }
+    if (trace != nullptr) {
+        trace->record(node, begin, end);
+    }
+}
+
+void evaluateNode(NodeBase* node, double& cost, bool sampling, ExecutionTrace* trace) {
+    measureEvaluation(node, cost, sampling, trace, [node]{ node->evaluate(); });
+}
+
+constexpr size_t NotFused = static_cast<size_t>(-1);
+
+// Evaluates the fused chain from the node on, each node handing its output value straight to the next
+// one, and returns the last node of the chain: the only one publishing its output. Valid nodes only hand
+// over the value they kept, so the chain resumes at its first invalid node.
+size_t evaluateChain(const std::vector<NodeBase*>& nodes, const std::vector<size_t>& fusedSuccessors,
+                     std::vector<double>& costs, size_t index, bool sampling, ExecutionTrace* trace) {
+    const void* value = nullptr;
+    while (true) {
+        NodeBase* node = nodes[index];
+        const bool last = fusedSuccessors[index] == NotFused;
+        measureEvaluation(node, costs[index], sampling, trace, [node, &value, last]{
+            value = node->evaluateFused(value, last);
+        });
+        if (last) {
+            return index;
+        }
+        index = fusedSuccessors[index];
+    }
+}
+
+// Longest path cost from each node to the end node, for nodes listed in topological order
+// together with all of their successors.
+void computeDownstreamCosts(const std::vector<size_t>& nodes, const std::vector<size_t>& successorOffsets,
+                            const std::vector<size_t>& successors, const std::vector<double>& costs,
+                            std::vector<double>& downstreamCosts) {
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+        double downstream = 0.0;
+        for (size_t i = successorOffsets[*it]; i < successorOffsets[*it + 1]; ++i) {
+            downstream = std::max(downstream, downstreamCosts[successors[i]]);
+        }
+        downstreamCosts[*it] = costs[*it] + downstream;
+    }
+}
+
+// Whether none of the nodes gained or lost an edge since their revisions were taken. Checked from the
+// end node backwards: destroying a node changes the revision of its consumers, which come after it in
+// the topological order, so the check stops before reaching a destroyed node.
+bool areEdgesUnchanged(const std::vector<NodeBase*>& nodes, const std::vector<size_t>& edgeRevisions) {
+    for (size_t i = nodes.size(); i-- > 0;) {
+        if (nodes[i]->getEdgeRevision() != edgeRevisions[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct ParallelState {
+    const std::vector<NodeBase*>& nodes;
+    const std::vector<size_t>&    successorOffsets;
+    const std::vector<size_t>&    successors;
+    // nullptr while fusion is disabled
+    const std::vector<size_t>*    fusedSuccessors;
+    const std::vector<size_t>&    visitMarks;
+    std::atomic<size_t>* const    pendingInputs;
+    std::vector<double>&          costs;
+    const std::vector<double>&    priorities;
+    const size_t                  visitEpoch;
+    const bool                    sampling;
+    ExecutionTrace* const         trace;
+    const std::atomic<bool>&      cancelRequested;
+    // once a node failed no more nodes are started, the first error is rethrown
+    std::atomic<bool>             failed;
+    std::mutex                    errorMutex;
+    std::exception_ptr            error;
+    // whether nodes were left out because of a cancellation
+    std::atomic<bool>             skipped;
+    WorkStealingPool::TaskRunner  runner;
+
+    bool comparePriority(size_t lhs, size_t rhs) const {
+        return priorities[lhs] < priorities[rhs];
+    }
+};
+
+// Tasks continuing after an asynchronous node, once it finished, have the flag set on its index.
+constexpr size_t ResumeTask = ~(~size_t(0) >> 1);
+
+void recordError(ParallelState& state, std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(state.errorMutex);
+    if (state.error == nullptr) {
+        state.error = std::move(error);
+    }
+    state.failed.store(true, std::memory_order_relaxed);
+}
+
+// Starts evaluating an asynchronous node without waiting for it: the job is suspended until the node
+// reports back, then the node's successors are released by a resumed task.
+void startAsyncNode(WorkStealingPool& pool, ParallelState& state, size_t index) {
+    pool.suspend();
+    const auto begin = Clock::now();
+    state.nodes[index]->evaluateAsync([&pool, &state, index, begin](std::exception_ptr error){
+        const auto end = Clock::now();
+        // the wait is part of the cost, it's what an asynchronous node delays its successors with
+        double& cost = state.costs[index];
+        const double duration = std::chrono::duration<double, std::nano>(end - begin).count();
+        cost = cost == 0.0 ? duration : cost + CostSmoothing * (duration - cost);
+        if (state.trace != nullptr) {
+            state.trace->record(state.nodes[index], begin, end);
+        }
+        if (error != nullptr) {
+            recordError(state, std::move(error));
+        }
+        pool.resume(index | ResumeTask);
+    });
+}
+
+// Evaluates the node, then goes on with the successor it made ready that has the highest priority,
+// while it still has the node's outputs in cache. The other ready successors are left on the worker's
+// deque, the highest priority on top.
+void runNode(WorkStealingPool& pool, ParallelState& state, size_t task, size_t worker) {
+    std::vector<size_t> ready;
+    size_t index = task & ~ResumeTask;
+    bool evaluated = (task & ResumeTask) != 0;
+    while (true) {
+        if (!evaluated) {
+            if (state.cancelRequested.load(std::memory_order_relaxed)) {
+                state.skipped.store(true, std::memory_order_relaxed);
+                return;
+            }
+            if (state.nodes[index]->isAsynchronous()) {
+                startAsyncNode(pool, state, index);
+                return;
+            }
+            try {
+                if (state.fusedSuccessors != nullptr && (*state.fusedSuccessors)[index] != NotFused) {
+                    // the rest of the chain is never scheduled, its successors are released by its last node
+                    index = evaluateChain(state.nodes, *state.fusedSuccessors, state.costs, index, state.sampling, state.trace);
+                } else {
+                    evaluateNode(state.nodes[index], state.costs[index], state.sampling, state.trace);
+                }
+            } catch (...) {
+                recordError(state, std::current_exception());
+            }
+        }
+        evaluated = false;
+        if (state.failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+        // the predecessor taking the counter to zero acquires the outputs of all the others
+        for (size_t i = state.successorOffsets[index]; i < state.successorOffsets[index + 1]; ++i) {
+            const size_t successor = state.successors[i];
+            if (state.visitMarks[successor] == state.visitEpoch &&
+                state.pendingInputs[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ready.push_back(successor);
+            }
+        }
+        if (ready.empty()) {
+            return;
+        }
+        std::sort(ready.begin(), ready.end(), [&state](size_t lhs, size_t rhs){
+            return state.comparePriority(lhs, rhs);
+        });
+        index = ready.back();
+        ready.pop_back();
+        for (size_t successor : ready) {
+            pool.spawn(worker, successor);
+        }
+        ready.clear();
+    }
+}
+
+}
+
+NodeExecution::NodeExecution(size_t threadCount) :
+    m_threadCount(threadCount),
+    m_profilingEnabled(false),
+    m_fusionEnabled(false),
+    m_tracing(false)
+{
+    if (threadCount == 0) {
+        throw PIPELINE_EXCEPTION("NodeExecution needs at least one thread");
+    }
+    if (threadCount > 1) {
+        m_threadPool = std::make_unique<WorkStealingPool>(threadCount);
+    }
+}
+
+NodeExecution::~NodeExecution() {
+    if (m_running != nullptr) {
+        ExecutionHandle(m_running).wait();
+    }
+    m_threadPool.reset();
+    m_nodes.clear();
+    for (auto* node : m_arenaNodes) {
+        node->~NodeBase();
+    }
 }
 
 void NodeExecution::execute(NodeBase *endNode) {
-    std::vector<NodeBase*> executionList = collectInputNodesToEvaluate(endNode);
-    while(!executionList.empty()) {
-        auto* node = *--executionList.end();
-        node->evaluate();
-        executionList.pop_back();
+    if (m_threadCount > 1) {
+        executeAsync(endNode).get();
+        return;
+    }
+    ExecutionPlan& plan = startExecution(endNode);
+    const bool sampling = plan.executionCount++ % CostSamplingPeriod == 0;
+    ExecutionTrace* const trace = m_tracing ? m_trace.get() : nullptr;
+    for (size_t index : plan.dirtyNodes) {
+        if (!m_fusionEnabled) {
+            evaluateNode(plan.nodes[index], plan.costs[index], sampling, trace);
+        } else if (plan.fusedPredecessors[index] != NotFused && plan.visitMarks[plan.fusedPredecessors[index]] == plan.visitEpoch) {
+            // evaluated with the dirty part of its chain already
+        } else if (plan.fusedSuccessors[index] != NotFused) {
+            evaluateChain(plan.nodes, plan.fusedSuccessors, plan.costs, index, sampling, trace);
+        } else {
+            evaluateNode(plan.nodes[index], plan.costs[index], sampling, trace);
+        }
+    }
+}
+
+ExecutionHandle NodeExecution::executeAsync(NodeBase* endNode) {
+    ExecutionPlan& plan = startExecution(endNode);
+    const bool sampling = plan.executionCount++ % CostSamplingPeriod == 0;
+    if (m_threadPool == nullptr) {
+        m_threadPool = std::make_unique<WorkStealingPool>(1);
+    }
+    const size_t epoch = plan.visitEpoch;
+    for (size_t index : plan.dirtyNodes) {
+        size_t pending = 0;
+        for (size_t i = plan.inputOffsets[index]; i < plan.inputOffsets[index + 1]; ++i) {
+            pending += plan.visitMarks[plan.inputs[i]] == epoch ? 1 : 0;
+        }
+        plan.pendingInputs[index].store(pending, std::memory_order_relaxed);
+    }
+    // the successors of a dirty node are dirty as well
+    computeDownstreamCosts(plan.dirtyNodes, plan.successorOffsets, plan.successors, plan.costs, plan.downstreamCosts);
+
+    auto handleState = std::make_shared<ExecutionHandle::State>();
+    std::shared_ptr<ParallelState> state(new ParallelState {
+        plan.nodes, plan.successorOffsets, plan.successors, m_fusionEnabled ? &plan.fusedSuccessors : nullptr,
+        plan.visitMarks, plan.pendingInputs.get(),
+        plan.costs, plan.downstreamCosts, epoch, sampling, m_tracing ? m_trace.get() : nullptr,
+        handleState->cancelRequested, { false }, {}, nullptr, { false }, nullptr });
+    WorkStealingPool& pool = *m_threadPool;
+    ParallelState* statePtr = state.get();
+    state->runner = [&pool, statePtr](size_t index, size_t worker){
+        runNode(pool, *statePtr, index, worker);
+    };
+
+    std::vector<size_t> initialNodes;
+    for (size_t index : plan.dirtyNodes) {
+        if (plan.pendingInputs[index].load(std::memory_order_relaxed) == 0) {
+            initialNodes.push_back(index);
+        }
+    }
+    std::sort(initialNodes.begin(), initialNodes.end(), [statePtr](size_t lhs, size_t rhs){
+        return statePtr->comparePriority(rhs, lhs);
+    });
+    m_running = handleState;
+    // the job holds on to the state until it finished
+    pool.start(state->runner, initialNodes, [state, handleState]{
+        if (state->error != nullptr) {
+            handleState->complete(ExecutionHandle::Status::Failed, state->error);
+        } else if (state->skipped.load(std::memory_order_relaxed)) {
+            handleState->complete(ExecutionHandle::Status::Cancelled, nullptr);
+        } else {
+            handleState->complete(ExecutionHandle::Status::Completed, nullptr);
+        }
+    });
+    return ExecutionHandle(handleState);
+}
+
+size_t NodeExecution::getThreadCount() const {
+    return m_threadCount;
+}
+
+void NodeExecution::setProfilingEnabled(bool enabled) {
+    m_profilingEnabled = enabled;
+}
+
+bool NodeExecution::isProfilingEnabled() const {
+    return m_profilingEnabled;
+}
+
+std::vector<std::pair<const NodeBase*, NodeProfile>> NodeExecution::getProfiles(NodeBase* endNode) {
+    checkIdle();
+    std::vector<std::pair<const NodeBase*, NodeProfile>> profiles;
+    for (const auto* node : getPlan(endNode).nodes) {
+        if (node->getProfile() != nullptr) {
+            profiles.emplace_back(node, *node->getProfile());
+        }
+    }
+    return profiles;
+}
+
+void NodeExecution::setFusionEnabled(bool enabled) {
+    m_fusionEnabled = enabled;
+}
+
+bool NodeExecution::isFusionEnabled() const {
+    return m_fusionEnabled;
+}
+
+void NodeExecution::startTrace() {
+    m_trace = std::make_unique<ExecutionTrace>();
+    m_tracing = true;
+}
+
+void NodeExecution::stopTrace() {
+    m_tracing = false;
+}
+
+void NodeExecution::writeTrace(std::ostream& stream) const {
+    if (m_trace == nullptr) {
+        throw PIPELINE_EXCEPTION("No trace was recorded");
+    }
+    m_trace->write(stream);
+}
+
+void NodeExecution::writeTrace(const std::string& path) const {
+    std::ofstream stream(path);
+    if (!stream) {
+        throw PIPELINE_EXCEPTION("Cannot open the trace file");
+    }
+    writeTrace(stream);
+}
+
+std::vector<const NodeBase*> NodeExecution::getCriticalPath(NodeBase* endNode) {
+    checkIdle();
+    ExecutionPlan& plan = getPlan(endNode);
+    std::vector<size_t> allNodes(plan.nodes.size());
+    std::iota(allNodes.begin(), allNodes.end(), 0);
+    computeDownstreamCosts(allNodes, plan.successorOffsets, plan.successors, plan.costs, plan.downstreamCosts);
+
+    const auto compareDownstreamCost = [&plan](size_t lhs, size_t rhs){
+        return plan.downstreamCosts[lhs] < plan.downstreamCosts[rhs];
+    };
+    // the heaviest path starts at a node without inputs, and continues with the heaviest successor
+    size_t index = plan.nodes.size() - 1;
+    for (size_t i = 0; i < plan.nodes.size(); ++i) {
+        if (plan.inputOffsets[i] == plan.inputOffsets[i + 1] && compareDownstreamCost(index, i)) {
+            index = i;
+        }
+    }
+    std::vector<const NodeBase*> path { plan.nodes[index] };
+    while (plan.successorOffsets[index] != plan.successorOffsets[index + 1]) {
+        index = *std::max_element(plan.successors.begin() + plan.successorOffsets[index],
+                                  plan.successors.begin() + plan.successorOffsets[index + 1], compareDownstreamCost);
+        path.push_back(plan.nodes[index]);
+    }
+    return path;
+}
+
+std::chrono::nanoseconds NodeExecution::estimateMakespan(NodeBase* endNode, size_t threadCount) {
+    if (threadCount == 0) {
+        throw PIPELINE_EXCEPTION("Makespan estimation needs at least one thread");
+    }
+    checkIdle();
+    ExecutionPlan& plan = getPlan(endNode);
+    const size_t nodeCount = plan.nodes.size();
+    std::vector<size_t> allNodes(nodeCount);
+    std::iota(allNodes.begin(), allNodes.end(), 0);
+    computeDownstreamCosts(allNodes, plan.successorOffsets, plan.successors, plan.costs, plan.downstreamCosts);
+
+    // list scheduling simulation of a full re-evaluation, with the same priorities as the execution
+    const auto comparePriority = [&plan](size_t lhs, size_t rhs){
+        return plan.downstreamCosts[lhs] < plan.downstreamCosts[rhs];
+    };
+    using Running = std::pair<double, size_t>;
+    std::priority_queue<size_t, std::vector<size_t>, decltype(comparePriority)> ready(comparePriority);
+    std::priority_queue<Running, std::vector<Running>, std::greater<Running>> running;
+    std::vector<size_t> pendingInputs(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        pendingInputs[i] = plan.inputOffsets[i + 1] - plan.inputOffsets[i];
+        if (pendingInputs[i] == 0) {
+            ready.push(i);
+        }
+    }
+    double time = 0.0;
+    while (!ready.empty() || !running.empty()) {
+        while (!ready.empty() && running.size() < threadCount) {
+            running.emplace(time + plan.costs[ready.top()], ready.top());
+            ready.pop();
+        }
+        const Running finished = running.top();
+        running.pop();
+        time = finished.first;
+        for (size_t i = plan.successorOffsets[finished.second]; i < plan.successorOffsets[finished.second + 1]; ++i) {
+            if (--pendingInputs[plan.successors[i]] == 0) {
+                ready.push(plan.successors[i]);
+            }
+        }
+    }
+    return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(time));
+}
+
+NodeExecution::PlanRelease::PlanRelease(NodeExecution& execution, NodeBase& endNode) :
+    m_execution(execution),
+    m_endNode(&endNode)
+{
+    endNode.attach(this);
+}
+
+void NodeExecution::PlanRelease::targetDeleted() {
+    // destroys this as well
+    m_execution.m_plans.erase(m_endNode);
+}
+
+NodeExecution::ExecutionPlan& NodeExecution::getPlan(NodeBase* endNode) {
+    const size_t topologyRevision = getTopologyRevision();
+    ExecutionPlan& plan = m_plans[endNode];
+    // edges changing in other parts of the graph, or in other graphs, keep the plan
+    if (!plan.nodes.empty() &&
+        (plan.topologyRevision == topologyRevision || areEdgesUnchanged(plan.nodes, plan.edgeRevisions))) {
+        plan.topologyRevision = topologyRevision;
+        return plan;
+    }
+    if (plan.release == nullptr) {
+        plan.release = std::make_unique<PlanRelease>(*this, *endNode);
+    }
+
+    std::unordered_map<const NodeBase*, double> previousCosts;
+    for (size_t i = 0; i < plan.nodes.size(); ++i) {
+        previousCosts.emplace(plan.nodes[i], plan.costs[i]);
+    }
+    plan.topologyRevision = topologyRevision;
+    plan.nodes = collectExecutionOrder(endNode);
+    const size_t nodeCount = plan.nodes.size();
+    std::unordered_map<const NodeBase*, size_t> indices;
+    indices.reserve(nodeCount);
+    plan.costs.assign(nodeCount, 0.0);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        indices.emplace(plan.nodes[i], i);
+        // measurements of the nodes that remain in the plan are kept
+        const auto it = previousCosts.find(plan.nodes[i]);
+        if (it != previousCosts.end()) {
+            plan.costs[i] = it->second;
+        }
+    }
+    plan.downstreamCosts.assign(nodeCount, 0.0);
+    plan.executionCount = 0;
+    plan.edgeRevisions.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        plan.edgeRevisions[i] = plan.nodes[i]->getEdgeRevision();
+    }
+
+    // adjacency is stored flat: inputs of node i are in inputs[inputOffsets[i] .. inputOffsets[i+1]),
+    // and likewise for successors
+    plan.inputOffsets.assign(1, 0);
+    plan.inputs.clear();
+    plan.successorOffsets.assign(nodeCount + 1, 0);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        for (auto* inputNode : plan.nodes[i]->getInputNodes()) {
+            const size_t inputIndex = indices.at(inputNode);
+            plan.inputs.push_back(inputIndex);
+            ++plan.successorOffsets[inputIndex + 1];
+        }
+        plan.inputOffsets.push_back(plan.inputs.size());
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        plan.successorOffsets[i + 1] += plan.successorOffsets[i];
+    }
+    plan.successors.resize(plan.successorOffsets[nodeCount]);
+    std::vector<size_t> fill(plan.successorOffsets.begin(), plan.successorOffsets.end() - 1);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        for (size_t j = plan.inputOffsets[i]; j < plan.inputOffsets[i + 1]; ++j) {
+            plan.successors[fill[plan.inputs[j]]++] = i;
+        }
+    }
+
+    // a node is fused with its only successor when it's the only consumer of the node's output,
+    // which nothing else needs to see then
+    plan.fusedSuccessors.assign(nodeCount, NotFused);
+    plan.fusedPredecessors.assign(nodeCount, NotFused);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        if (plan.successorOffsets[i + 1] - plan.successorOffsets[i] != 1) {
+            continue;
+        }
+        const size_t successor = plan.successors[plan.successorOffsets[i]];
+        if (plan.nodes[i]->isFusible() && plan.nodes[successor]->isFusible() &&
+            plan.nodes[i]->getOutputNodes().size() == 1) {
+            plan.fusedSuccessors[i] = successor;
+            plan.fusedPredecessors[successor] = i;
+        }
+    }
+
+    plan.visitMarks.assign(nodeCount, 0);
+    plan.pendingInputs = std::make_unique<std::atomic<size_t>[]>(nodeCount);
+    plan.visitEpoch = 0;
+    // a recompiled plan may contain new nodes to profile, while the old ones
+    // still have to be disabled if profiling got turned off
+    plan.profiled = plan.profiled && !m_profilingEnabled;
+    return plan;
+}
+
+// Invalidation always reaches every downstream node, so a valid node has a valid upstream
+// and the walk can stop there: only the invalid part of the plan is visited, returned in
+// topological order. A valid node without its output, left by a fused chain, is visited as well:
+// it has to be evaluated again for its consumer.
+void NodeExecution::collectDirtyNodes(ExecutionPlan& plan) {
+    std::vector<size_t>& dirtyNodes = plan.dirtyNodes;
+    dirtyNodes.clear();
+    const size_t endIndex = plan.nodes.size() - 1;
+    if (plan.nodes[endIndex]->isDataValid() && !plan.nodes[endIndex]->isOutputElided()) {
+        countCacheHit(plan.nodes[endIndex]);
+        return;
+    }
+    // dirty nodes are marked with the epoch, and the valid nodes the walk stops at with the value
+    // right before it, so a node shared by several dirty consumers counts a single cache hit
+    plan.visitEpoch += 2;
+    const size_t epoch = plan.visitEpoch;
+    std::vector<std::pair<size_t, size_t>> stack { { endIndex, plan.inputOffsets[endIndex] } };
+    plan.visitMarks[endIndex] = epoch;
+    while (!stack.empty()) {
+        const size_t index = stack.back().first;
+        size_t& nextInput = stack.back().second;
+        if (nextInput < plan.inputOffsets[index + 1]) {
+            const size_t inputIndex = plan.inputs[nextInput++];
+            if (plan.visitMarks[inputIndex] >= epoch - 1) {
+                continue;
+            }
+            if (plan.nodes[inputIndex]->isDataValid() && !plan.nodes[inputIndex]->isOutputElided()) {
+                plan.visitMarks[inputIndex] = epoch - 1;
+                countCacheHit(plan.nodes[inputIndex]);
+            } else {
+                plan.visitMarks[inputIndex] = epoch;
+                stack.emplace_back(inputIndex, plan.inputOffsets[inputIndex]);
+            }
+        } else {
+            dirtyNodes.push_back(index);
+            stack.pop_back();
+        }
+    }
+}
+
+void NodeExecution::checkIdle() const {
+    if (m_running != nullptr && !ExecutionHandle(m_running).isDone()) {
+        throw PIPELINE_EXCEPTION("Another execution is still running");
+    }
+}
+
+NodeExecution::ExecutionPlan& NodeExecution::startExecution(NodeBase* endNode) {
+    checkIdle();
+    // nodes invalidated in the batch still look valid, they would be served stale
+    if (InvalidationBatch::isActive()) {
+        throw PIPELINE_EXCEPTION("Cannot execute while an invalidation batch is open");
+    }
+    ExecutionPlan& plan = getPlan(endNode);
+    if (plan.profiled != m_profilingEnabled) {
+        for (auto* node : plan.nodes) {
+            node->enableProfiling(m_profilingEnabled);
+        }
+        plan.profiled = m_profilingEnabled;
+    }
+    collectDirtyNodes(plan);
+    if (m_tracing) {
+        m_trace->beginExecution();
     }
+    return plan;
 }
@@ -1,9 +1,11 @@
 #include "Observer.hpp"
 
 mfep::Pipeline::Observable::~Observable() {
-    for (auto* observer : m_observers) {
-        observer->m_target = nullptr;
-        observer->targetDeleted();
+    while (!m_observers.empty()) {
+        const Link link = m_observers.back();
+        m_observers.pop_back();
+        link.observer->removeSubscription(link.observerSlot);
+        link.observer->targetDeleted();
     }
 }
 
@@ -11,23 +13,52 @@ void mfep::Pipeline::Observable::attach(mfep::Pipeline::Observer *obs) {
     if (obs == nullptr) {
         throw PIPELINE_EXCEPTION("Cannot insert nullptr to observers");
     }
-    obs->m_target = this;
-    m_observers.insert(obs);
+    m_observers.push_back(Link{ obs, obs->m_targets.size() });
+    obs->m_targets.push_back(Observer::Subscription{ this, m_observers.size() - 1 });
 }
 
 void mfep::Pipeline::Observable::detach(mfep::Pipeline::Observer *obs) {
-    m_observers.erase(obs);
+    if (obs == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < obs->m_targets.size(); ++i) {
+        if (obs->m_targets[i].target == this) {
+            removeLink(obs->m_targets[i].targetSlot);
+            obs->removeSubscription(i);
+            return;
+        }
+    }
 }
 
 void mfep::Pipeline::Observable::changed() const {
-    for (auto* observer : m_observers) {
-        observer->targetChanged();
+    for (size_t i = 0; i < m_observers.size(); ++i) {
+        m_observers[i].observer->targetChanged();
+    }
+}
+
+void mfep::Pipeline::Observable::removeLink(size_t slot) {
+    const Link last = m_observers.back();
+    m_observers.pop_back();
+    if (slot < m_observers.size()) {
+        m_observers[slot] = last;
+        last.observer->m_targets[last.observerSlot].targetSlot = slot;
     }
 }
 
 mfep::Pipeline::Observer::~Observer() {
-    if (m_target != nullptr) {
-        m_target->detach(this);
+    while (!m_targets.empty()) {
+        const Subscription subscription = m_targets.back();
+        m_targets.pop_back();
+        subscription.target->removeLink(subscription.targetSlot);
+    }
+}
+
+void mfep::Pipeline::Observer::removeSubscription(size_t slot) {
+    const Subscription last = m_targets.back();
+    m_targets.pop_back();
+    if (slot < m_targets.size()) {
+        m_targets[slot] = last;
+        last.target->m_observers[last.targetSlot].observerSlot = slot;
     }
 }
 
@@ -0,0 +1,92 @@
+#include <unordered_map>
+#include "StreamExecution.hpp"
+#include "NodeAlgorithms.hpp"
+
+using namespace mfep::Pipeline;
+
+StreamExecution::StreamExecution(NodeBase* endNode, size_t queueCapacity) {
+    const std::vector<NodeBase*> nodes = collectExecutionOrder(endNode);
+    std::unordered_map<const NodeBase*, StreamStage*> stages;
+    for (auto* node : nodes) {
+        if (!node->isConnected()) {
+            throw PIPELINE_EXCEPTION("Cannot stream, not every input is connected");
+        }
+        m_stages.push_back(node->createStreamStage(queueCapacity));
+        stages.emplace(node, m_stages.back().get());
+    }
+    // every input queue gets the items of the output it's connected to
+    for (auto& stage : m_stages) {
+        for (size_t i = 0; i < stage->getInputCount(); ++i) {
+            const OutConnBase* source = stage->getInputSource(i);
+            stages.at(source->getOwnerNode())->subscribe(source, stage->getInput(i));
+        }
+    }
+    StreamStage& endStage = *m_stages.back();
+    for (size_t i = 0; i < endStage.getOutputCount(); ++i) {
+        m_outputs.push_back(endStage.createQueue(i, queueCapacity, Backpressure::Block));
+        endStage.subscribe(endNode->getOutConn(i), *m_outputs.back());
+    }
+    m_threads.reserve(m_stages.size());
+    try {
+        for (auto& stage : m_stages) {
+            StreamStage* stagePtr = stage.get();
+            m_threads.emplace_back([this, stagePtr]{ runStage(*stagePtr); });
+        }
+    } catch (...) {
+        stop();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+        throw;
+    }
+}
+
+StreamExecution::~StreamExecution() {
+    stop();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void StreamExecution::wait() {
+    for (auto& output : m_outputs) {
+        output->abandon();
+    }
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    if (m_error != nullptr) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void StreamExecution::stop() {
+    for (auto& stage : m_stages) {
+        stage->close();
+    }
+}
+
+StreamQueueBase* StreamExecution::getOutput(size_t outputIdx) {
+    if (outputIdx >= m_outputs.size()) {
+        throw PIPELINE_EXCEPTION("Output overindexed");
+    }
+    return m_outputs[outputIdx].get();
+}
+
+void StreamExecution::runStage(StreamStage& stage) {
+    try {
+        while (stage.step()) {
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            if (m_error == nullptr) {
+                m_error = std::current_exception();
+            }
+        }
+        stop();
+    }
+    stage.close();
+}
@@ -0,0 +1,313 @@
+#include <atomic>
+#include "VectorKernels.hpp"
+#include "PipelineException.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PIPELINE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace mfep::Pipeline;
+
+namespace {
+
+// One implementation of every kernel, for a given level.
+struct Kernels {
+    SimdLevel level;
+    void    (*addInt)       (const int32_t*, const int32_t*, int32_t*, size_t);
+    void    (*addFloat)     (const float*, const float*, float*, size_t);
+    void    (*multiplyInt)  (const int32_t*, const int32_t*, int32_t*, size_t);
+    void    (*multiplyFloat)(const float*, const float*, float*, size_t);
+    void    (*convert)      (const int32_t*, float*, size_t);
+    int32_t (*sumInt)       (const int32_t*, size_t);
+    float   (*sumFloat)     (const float*, size_t);
+};
+
+// integers are computed unsigned, where overflowing wraps around like in the vector registers
+int32_t add(int32_t lhs, int32_t rhs) {
+    return static_cast<int32_t>(static_cast<uint32_t>(lhs) + static_cast<uint32_t>(rhs));
+}
+float add(float lhs, float rhs) {
+    return lhs + rhs;
+}
+int32_t multiply(int32_t lhs, int32_t rhs) {
+    return static_cast<int32_t>(static_cast<uint32_t>(lhs) * static_cast<uint32_t>(rhs));
+}
+float multiply(float lhs, float rhs) {
+    return lhs * rhs;
+}
+
+// The scalar kernels also finish the items left over by the vectorized ones.
+template<typename T>
+void addScalar(const T* lhs, const T* rhs, T* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = add(lhs[i], rhs[i]);
+    }
+}
+template<typename T>
+void multiplyScalar(const T* lhs, const T* rhs, T* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = multiply(lhs[i], rhs[i]);
+    }
+}
+void convertScalar(const int32_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]);
+    }
+}
+template<typename T>
+T accumulate(const T* in, size_t count, T sum) {
+    for (size_t i = 0; i < count; ++i) {
+        sum = add(sum, in[i]);
+    }
+    return sum;
+}
+template<typename T>
+T sumScalar(const T* in, size_t count) {
+    return accumulate(in, count, T());
+}
+
+const Kernels scalarKernels {
+    SimdLevel::Scalar,
+    &addScalar<int32_t>,
+    &addScalar<float>,
+    &multiplyScalar<int32_t>,
+    &multiplyScalar<float>,
+    &convertScalar,
+    &sumScalar<int32_t>,
+    &sumScalar<float>
+};
+
+#ifdef PIPELINE_X86_KERNELS
+
+__attribute__((target("avx2")))
+void addIntAvx2(const int32_t* lhs, const int32_t* rhs, int32_t* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i left  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(left, right));
+    }
+    addScalar(lhs + i, rhs + i, out + i, count - i);
+}
+__attribute__((target("avx2")))
+void addFloatAvx2(const float* lhs, const float* rhs, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i)));
+    }
+    addScalar(lhs + i, rhs + i, out + i, count - i);
+}
+__attribute__((target("avx2")))
+void multiplyIntAvx2(const int32_t* lhs, const int32_t* rhs, int32_t* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i left  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_mullo_epi32(left, right));
+    }
+    multiplyScalar(lhs + i, rhs + i, out + i, count - i);
+}
+__attribute__((target("avx2")))
+void multiplyFloatAvx2(const float* lhs, const float* rhs, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i)));
+    }
+    multiplyScalar(lhs + i, rhs + i, out + i, count - i);
+}
+__attribute__((target("avx2")))
+void convertAvx2(const int32_t* in, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i))));
+    }
+    convertScalar(in + i, out + i, count - i);
+}
+__attribute__((target("avx2")))
+int32_t sumIntAvx2(const int32_t* in, size_t count) {
+    __m256i sums = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        sums = _mm256_add_epi32(sums, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+    }
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sums);
+    return accumulate(in + i, count - i, sumScalar(lanes, 8));
+}
+__attribute__((target("avx2")))
+float sumFloatAvx2(const float* in, size_t count) {
+    __m256 sums = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        sums = _mm256_add_ps(sums, _mm256_loadu_ps(in + i));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, sums);
+    return accumulate(in + i, count - i, sumScalar(lanes, 8));
+}
+
+const Kernels avx2Kernels {
+    SimdLevel::Avx2,
+    &addIntAvx2,
+    &addFloatAvx2,
+    &multiplyIntAvx2,
+    &multiplyFloatAvx2,
+    &convertAvx2,
+    &sumIntAvx2,
+    &sumFloatAvx2
+};
+
+__attribute__((target("avx512f")))
+void addIntAvx512(const int32_t* lhs, const int32_t* rhs, int32_t* out, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_si512(out + i, _mm512_add_epi32(_mm512_loadu_si512(lhs + i), _mm512_loadu_si512(rhs + i)));
+    }
+    addScalar(lhs + i, rhs + i, out + i, count - i);
+}
+__attribute__((target("avx512f")))
+void addFloatAvx512(const float* lhs, const float* rhs, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(lhs + i), _mm512_loadu_ps(rhs + i)));
+    }
+    addScalar(lhs + i, rhs + i, out + i, count - i);
+}
+__attribute__((target("avx512f")))
+void multiplyIntAvx512(const int32_t* lhs, const int32_t* rhs, int32_t* out, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_si512(out + i, _mm512_mullo_epi32(_mm512_loadu_si512(lhs + i), _mm512_loadu_si512(rhs + i)));
+    }
+    multiplyScalar(lhs + i, rhs + i, out + i, count - i);
+}
+__attribute__((target("avx512f")))
+void multiplyFloatAvx512(const float* lhs, const float* rhs, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(lhs + i), _mm512_loadu_ps(rhs + i)));
+    }
+    multiplyScalar(lhs + i, rhs + i, out + i, count - i);
+}
+__attribute__((target("avx512f")))
+void convertAvx512(const int32_t* in, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(out + i, _mm512_cvtepi32_ps(_mm512_loadu_si512(in + i)));
+    }
+    convertScalar(in + i, out + i, count - i);
+}
+__attribute__((target("avx512f")))
+int32_t sumIntAvx512(const int32_t* in, size_t count) {
+    __m512i sums = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        sums = _mm512_add_epi32(sums, _mm512_loadu_si512(in + i));
+    }
+    return accumulate(in + i, count - i, static_cast<int32_t>(_mm512_reduce_add_epi32(sums)));
+}
+__attribute__((target("avx512f")))
+float sumFloatAvx512(const float* in, size_t count) {
+    __m512 sums = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        sums = _mm512_add_ps(sums, _mm512_loadu_ps(in + i));
+    }
+    return accumulate(in + i, count - i, _mm512_reduce_add_ps(sums));
+}
+
+const Kernels avx512Kernels {
+    SimdLevel::Avx512,
+    &addIntAvx512,
+    &addFloatAvx512,
+    &multiplyIntAvx512,
+    &multiplyFloatAvx512,
+    &convertAvx512,
+    &sumIntAvx512,
+    &sumFloatAvx512
+};
+
+#endif
+
+SimdLevel detectSimdLevel() {
+#ifdef PIPELINE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+const Kernels* getKernels(SimdLevel level) {
+    switch (level) {
+#ifdef PIPELINE_X86_KERNELS
+    case SimdLevel::Avx512:
+        return &avx512Kernels;
+    case SimdLevel::Avx2:
+        return &avx2Kernels;
+#endif
+    default:
+        return &scalarKernels;
+    }
+}
+
+// picked on first use, so the detection doesn't depend on the order of static initialization
+std::atomic<const Kernels*>& activeKernels() {
+    static std::atomic<const Kernels*> kernels { getKernels(getSupportedSimdLevel()) };
+    return kernels;
+}
+
+const Kernels& kernels() {
+    return *activeKernels().load(std::memory_order_acquire);
+}
+
+}
+
+SimdLevel mfep::Pipeline::getSupportedSimdLevel() {
+    static const SimdLevel supported = detectSimdLevel();
+    return supported;
+}
+
+SimdLevel mfep::Pipeline::getSimdLevel() {
+    return kernels().level;
+}
+
+void mfep::Pipeline::setSimdLevel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(getSupportedSimdLevel())) {
+        throw PIPELINE_EXCEPTION("The CPU doesn't support the SIMD level");
+    }
+    activeKernels().store(getKernels(level), std::memory_order_release);
+}
+
+void mfep::Pipeline::vectorAdd(const int32_t* lhs, const int32_t* rhs, int32_t* out, size_t count) {
+    kernels().addInt(lhs, rhs, out, count);
+}
+
+void mfep::Pipeline::vectorAdd(const float* lhs, const float* rhs, float* out, size_t count) {
+    kernels().addFloat(lhs, rhs, out, count);
+}
+
+void mfep::Pipeline::vectorMultiply(const int32_t* lhs, const int32_t* rhs, int32_t* out, size_t count) {
+    kernels().multiplyInt(lhs, rhs, out, count);
+}
+
+void mfep::Pipeline::vectorMultiply(const float* lhs, const float* rhs, float* out, size_t count) {
+    kernels().multiplyFloat(lhs, rhs, out, count);
+}
+
+void mfep::Pipeline::vectorConvert(const int32_t* in, float* out, size_t count) {
+    kernels().convert(in, out, count);
+}
+
+int32_t mfep::Pipeline::vectorSum(const int32_t* in, size_t count) {
+    return kernels().sumInt(in, count);
+}
+
+float mfep::Pipeline::vectorSum(const float* in, size_t count) {
+    return kernels().sumFloat(in, count);
+}
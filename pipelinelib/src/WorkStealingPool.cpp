@@ -0,0 +1,201 @@
+#include "WorkStealingPool.hpp"
+#include "PipelineException.hpp"
+
+using namespace mfep::Pipeline;
+
+namespace {
+
+// Rounds of looking for a task an idle worker does before going to sleep: tasks of fine-grained
+// jobs get spawned again quickly, sleeping and waking up costs more than spinning a bit.
+constexpr size_t IdleSpinRounds = 64;
+
+}
+
+WorkStealingPool::WorkStealingPool(size_t threadCount) :
+    m_runner(nullptr),
+    m_nextInitialTask(0),
+    m_resumedCount(0),
+    m_outstanding(0),
+    m_sleeping(0),
+    m_generation(0),
+    m_activeWorkers(0),
+    m_stopping(false)
+{
+    if (threadCount == 0) {
+        throw PIPELINE_EXCEPTION("Thread pool needs at least one thread");
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back([this, i]{ workerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobStarted.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::start(const TaskRunner& runner, const std::vector<size_t>& tasks, std::function<void()> onFinished) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_runner != nullptr) {
+        throw PIPELINE_EXCEPTION("The thread pool is already running a job");
+    }
+    if (tasks.empty()) {
+        lock.unlock();
+        onFinished();
+        return;
+    }
+    m_runner = &runner;
+    m_onFinished = std::move(onFinished);
+    m_initialTasks = tasks;
+    m_nextInitialTask.store(0, std::memory_order_relaxed);
+    m_outstanding.store(tasks.size(), std::memory_order_relaxed);
+    ++m_generation;
+    m_jobStarted.notify_all();
+}
+
+void WorkStealingPool::run(const TaskRunner& runner, const std::vector<size_t>& tasks) {
+    bool finished = false;
+    start(runner, tasks, [this, &finished]{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finished = true;
+        m_jobFinished.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobFinished.wait(lock, [&finished]{ return finished; });
+}
+
+void WorkStealingPool::spawn(size_t worker, size_t task) {
+    m_outstanding.fetch_add(1, std::memory_order_relaxed);
+    m_workers[worker]->deque.push(task);
+    // pairs with the fence of a worker going to sleep: either it sees the task, or this sees it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_workAvailable.notify_one();
+    }
+}
+
+void WorkStealingPool::suspend() {
+    m_outstanding.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WorkStealingPool::resume(size_t task) {
+    // sleeping workers check for work under the mutex, they can't miss the task
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_resumedTasks.push_back(task);
+    m_resumedCount.store(m_resumedTasks.size(), std::memory_order_release);
+    m_workAvailable.notify_one();
+}
+
+size_t WorkStealingPool::getThreadCount() const {
+    return m_threads.size();
+}
+
+void WorkStealingPool::workerLoop(size_t worker) {
+    size_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        // a worker waking up after the job finished doesn't join it anymore
+        m_jobStarted.wait(lock, [this, &seenGeneration]{
+            return m_stopping || (m_generation != seenGeneration && m_outstanding.load(std::memory_order_relaxed) > 0);
+        });
+        if (m_stopping) {
+            return;
+        }
+        seenGeneration = m_generation;
+        ++m_activeWorkers;
+        lock.unlock();
+        work(worker);
+        lock.lock();
+        // workers only leave once every task finished, and no one joins anymore: the job is over
+        if (--m_activeWorkers == 0) {
+            std::function<void()> onFinished = std::move(m_onFinished);
+            m_onFinished = nullptr;
+            m_runner = nullptr;
+            lock.unlock();
+            onFinished();
+            lock.lock();
+        }
+    }
+}
+
+void WorkStealingPool::work(size_t worker) {
+    size_t idleRounds = 0;
+    while (m_outstanding.load(std::memory_order_acquire) > 0) {
+        size_t task;
+        if (findTask(worker, task)) {
+            (*m_runner)(task, worker);
+            if (m_outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_workAvailable.notify_all();
+            }
+            idleRounds = 0;
+            continue;
+        }
+        if (++idleRounds < IdleSpinRounds) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_sleeping.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!hasWork() && m_outstanding.load(std::memory_order_acquire) > 0) {
+            m_workAvailable.wait(lock);
+        }
+        m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        idleRounds = 0;
+    }
+}
+
+bool WorkStealingPool::findTask(size_t worker, size_t& task) {
+    if (m_workers[worker]->deque.pop(task)) {
+        return true;
+    }
+    if (m_resumedCount.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_resumedTasks.empty()) {
+            task = m_resumedTasks.back();
+            m_resumedTasks.pop_back();
+            m_resumedCount.store(m_resumedTasks.size(), std::memory_order_relaxed);
+            return true;
+        }
+    }
+    if (m_nextInitialTask.load(std::memory_order_relaxed) < m_initialTasks.size()) {
+        const size_t index = m_nextInitialTask.fetch_add(1, std::memory_order_relaxed);
+        if (index < m_initialTasks.size()) {
+            task = m_initialTasks[index];
+            return true;
+        }
+    }
+    for (size_t i = 1; i < m_workers.size(); ++i) {
+        if (m_workers[(worker + i) % m_workers.size()]->deque.steal(task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkStealingPool::hasWork() const {
+    if (!m_resumedTasks.empty()) {
+        return true;
+    }
+    if (m_nextInitialTask.load(std::memory_order_relaxed) < m_initialTasks.size()) {
+        return true;
+    }
+    for (const auto& worker : m_workers) {
+        if (!worker->deque.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include "BenchNodes.hpp"
+#include "InputAdapter.hpp"
+
+using namespace mfep::Pipeline;
+using namespace mfep::Pipeline::Bench;
+
+namespace {
+
+struct Base {
+    virtual ~Base() = default;
+    virtual unsigned get() const { return 0; }
+};
+struct FirstDerived : public Base {
+    unsigned value = 1;
+    unsigned get() const override { return value; }
+};
+struct SecondDerived : public Base {
+    unsigned value = 2;
+    unsigned get() const override { return value * 2; }
+};
+
+class FirstSourceNode : public Node<tuple<>, tuple<FirstDerived>> {
+public:
+    void touch() {
+        invalidate();
+    }
+
+private:
+    OutData process(const InData&) const override {
+        return OutData{ std::make_unique<FirstDerived>() };
+    }
+};
+
+class BaseConsumerNode : public Node<tuple<Base>, tuple<unsigned>> {
+    OutData process(const InData& input) const override {
+        return OutData{ std::make_unique<unsigned>(std::get<0>(input).get()) };
+    }
+};
+
+class FirstConsumerNode : public Node<tuple<FirstDerived>, tuple<unsigned>> {
+    OutData process(const InData& input) const override {
+        return OutData{ std::make_unique<unsigned>(std::get<0>(input).get()) };
+    }
+};
+
+void BM_AdapterEvaluation(benchmark::State& state) {
+    NodeExecution exec;
+    auto& source = exec.createNode<FirstSourceNode>();
+    auto& adapter = exec.createNode<AdapterNode<tuple<FirstDerived, SecondDerived>, Base>>();
+    auto& consumer = exec.createNode<BaseConsumerNode>();
+    adapter.connect(source, 0, 0);
+    consumer.connect(adapter, 0, 0);
+    for (auto _ : state) {
+        source.touch();
+        exec.execute(&consumer);
+    }
+}
+BENCHMARK(BM_AdapterEvaluation);
+
+// the same evaluation with a direct, typed connection as a baseline
+void BM_DirectEvaluation(benchmark::State& state) {
+    NodeExecution exec;
+    auto& source = exec.createNode<FirstSourceNode>();
+    auto& consumer = exec.createNode<FirstConsumerNode>();
+    consumer.connect(source, 0, 0);
+    for (auto _ : state) {
+        source.touch();
+        exec.execute(&consumer);
+    }
+}
+BENCHMARK(BM_DirectEvaluation);
+
+void BM_AdapterConnect(benchmark::State& state) {
+    FirstSourceNode source;
+    AdapterNode<tuple<FirstDerived, SecondDerived>, Base> adapter;
+    for (auto _ : state) {
+        adapter.connect(source, 0, 0);
+    }
+}
+BENCHMARK(BM_AdapterConnect);
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include "NodeStructure.hpp"
+#include "NodeExecution.hpp"
+
+namespace mfep {
+namespace Pipeline {
+namespace Bench {
+
+// unsigned arithmetic so that wide and diamond-shaped graphs may overflow without UB
+class SourceNode : public Node<tuple<>, tuple<unsigned>> {
+public:
+    void setValue(unsigned value) {
+        m_value = value;
+        invalidate();
+    }
+
+private:
+    OutData process(const InData&) const override {
+        return OutData{ std::make_unique<unsigned>(m_value) };
+    }
+    unsigned m_value = 0;
+};
+
+class IncrementNode : public Node<tuple<unsigned>, tuple<unsigned>> {
+    OutData process(const InData& input) const override {
+        return OutData{ std::make_unique<unsigned>(std::get<0>(input) + 1) };
+    }
+};
+
+class AddNode : public Node<tuple<unsigned, unsigned>, tuple<unsigned>> {
+    OutData process(const InData& input) const override {
+        return OutData{ std::make_unique<unsigned>(std::get<0>(input) + std::get<1>(input)) };
+    }
+};
+
+struct BenchGraph {
+    std::vector<SourceNode*> sources;
+    NodeBase*                endNode;
+};
+
+inline void setSources(const BenchGraph& graph, unsigned value) {
+    InvalidationBatch batch;
+    for (auto* source : graph.sources) {
+        source->setValue(value);
+    }
+}
+
+inline NodeBase& reduce(NodeExecution& exec, std::vector<NodeBase*> nodes) {
+    while (nodes.size() > 1) {
+        std::vector<NodeBase*> reduced;
+        for (size_t i = 0; i + 1 < nodes.size(); i += 2) {
+            auto& add = exec.createNode<AddNode>();
+            add.connect(*nodes[i], 0, 0);
+            add.connect(*nodes[i + 1], 1, 0);
+            reduced.push_back(&add);
+        }
+        if (nodes.size() % 2 == 1) {
+            reduced.push_back(nodes.back());
+        }
+        nodes = std::move(reduced);
+    }
+    return *nodes.front();
+}
+
+// source -> increment -> increment -> ...
+inline BenchGraph buildChain(NodeExecution& exec, size_t length) {
+    BenchGraph graph { { &exec.createNode<SourceNode>() }, nullptr };
+    NodeBase* last = graph.sources.front();
+    for (size_t i = 0; i < length; ++i) {
+        auto& increment = exec.createNode<IncrementNode>();
+        increment.connect(*last, 0, 0);
+        last = &increment;
+    }
+    graph.endNode = last;
+    return graph;
+}
+
+// every level splits into two increments that are added back together
+inline BenchGraph buildDiamond(NodeExecution& exec, size_t levels) {
+    BenchGraph graph { { &exec.createNode<SourceNode>() }, nullptr };
+    NodeBase* last = graph.sources.front();
+    for (size_t i = 0; i < levels; ++i) {
+        auto& left = exec.createNode<IncrementNode>();
+        auto& right = exec.createNode<IncrementNode>();
+        auto& add = exec.createNode<AddNode>();
+        left.connect(*last, 0, 0);
+        right.connect(*last, 0, 0);
+        add.connect(left, 0, 0);
+        add.connect(right, 1, 0);
+        last = &add;
+    }
+    graph.endNode = last;
+    return graph;
+}
+
+// independent source -> increment lanes, summed by a balanced tree of adds
+inline BenchGraph buildWide(NodeExecution& exec, size_t width) {
+    BenchGraph graph { {}, nullptr };
+    std::vector<NodeBase*> lanes;
+    for (size_t i = 0; i < width; ++i) {
+        graph.sources.push_back(&exec.createNode<SourceNode>());
+        auto& increment = exec.createNode<IncrementNode>();
+        increment.connect(*graph.sources.back(), 0, 0);
+        lanes.push_back(&increment);
+    }
+    graph.endNode = &reduce(exec, lanes);
+    return graph;
+}
+
+// adds whose inputs are picked at random from the preceding nodes, then summed up
+inline BenchGraph buildRandom(NodeExecution& exec, size_t nodeCount, unsigned seed = 42) {
+    BenchGraph graph { {}, nullptr };
+    std::mt19937 random(seed);
+    std::vector<NodeBase*> nodes;
+    const size_t sourceCount = std::max<size_t>(2, nodeCount / 16);
+    for (size_t i = 0; i < sourceCount; ++i) {
+        graph.sources.push_back(&exec.createNode<SourceNode>());
+        nodes.push_back(graph.sources.back());
+    }
+    std::vector<bool> consumed(sourceCount, false);
+    for (size_t i = sourceCount; i < nodeCount; ++i) {
+        std::uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+        const size_t lhs = pick(random), rhs = pick(random);
+        auto& add = exec.createNode<AddNode>();
+        add.connect(*nodes[lhs], 0, 0);
+        add.connect(*nodes[rhs], 1, 0);
+        consumed[lhs] = consumed[rhs] = true;
+        nodes.push_back(&add);
+        consumed.push_back(false);
+    }
+    std::vector<NodeBase*> sinks;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!consumed[i]) {
+            sinks.push_back(nodes[i]);
+        }
+    }
+    graph.endNode = &reduce(exec, sinks);
+    return graph;
+}
+
+}
+}
+}
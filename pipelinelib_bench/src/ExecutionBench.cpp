@@ -0,0 +1,67 @@
+#include <functional>
+#include <benchmark/benchmark.h>
+#include "BenchNodes.hpp"
+
+using namespace mfep::Pipeline;
+using namespace mfep::Pipeline::Bench;
+
+namespace {
+
+using GraphBuilder = std::function<BenchGraph(NodeExecution&, size_t)>;
+
+// Every iteration changes all sources and executes the whole graph again.
+void fullExecution(benchmark::State& state, const GraphBuilder& builder) {
+    NodeExecution exec(static_cast<size_t>(state.range(1)));
+    const BenchGraph graph = builder(exec, static_cast<size_t>(state.range(0)));
+    unsigned value = 0;
+    for (auto _ : state) {
+        setSources(graph, ++value);
+        exec.execute(graph.endNode);
+    }
+    state.counters["threads"] = static_cast<double>(exec.getThreadCount());
+}
+
+// Every iteration changes a single source: only its downstream cone is dirty.
+void singleChangeExecution(benchmark::State& state, const GraphBuilder& builder) {
+    NodeExecution exec(static_cast<size_t>(state.range(1)));
+    const BenchGraph graph = builder(exec, static_cast<size_t>(state.range(0)));
+    exec.execute(graph.endNode);
+    unsigned value = 0;
+    for (auto _ : state) {
+        graph.sources.front()->setValue(++value);
+        exec.execute(graph.endNode);
+    }
+}
+
+// Nothing changes between iterations: the cost of finding out that everything is valid.
+void steadyStateExecution(benchmark::State& state, const GraphBuilder& builder) {
+    NodeExecution exec(static_cast<size_t>(state.range(1)));
+    const BenchGraph graph = builder(exec, static_cast<size_t>(state.range(0)));
+    exec.execute(graph.endNode);
+    for (auto _ : state) {
+        exec.execute(graph.endNode);
+    }
+}
+
+BenchGraph chain(NodeExecution& exec, size_t size) { return buildChain(exec, size); }
+BenchGraph diamond(NodeExecution& exec, size_t size) { return buildDiamond(exec, size); }
+BenchGraph wide(NodeExecution& exec, size_t size) { return buildWide(exec, size); }
+BenchGraph random(NodeExecution& exec, size_t size) { return buildRandom(exec, size); }
+
+void executionArguments(benchmark::internal::Benchmark* benchmark) {
+    for (long threads : { 1, 4 }) {
+        for (long size : { 64, 1024, 16384 }) {
+            benchmark->Args({ size, threads });
+        }
+    }
+}
+
+BENCHMARK_CAPTURE(fullExecution, chain, chain)->Apply(executionArguments);
+BENCHMARK_CAPTURE(fullExecution, diamond, diamond)->Apply(executionArguments);
+BENCHMARK_CAPTURE(fullExecution, wide, wide)->Apply(executionArguments);
+BENCHMARK_CAPTURE(fullExecution, random, random)->Apply(executionArguments);
+BENCHMARK_CAPTURE(singleChangeExecution, wide, wide)->Apply(executionArguments);
+BENCHMARK_CAPTURE(singleChangeExecution, random, random)->Apply(executionArguments);
+BENCHMARK_CAPTURE(steadyStateExecution, wide, wide)->Apply(executionArguments);
+
+}
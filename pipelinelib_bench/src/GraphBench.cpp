@@ -0,0 +1,86 @@
+#include <random>
+#include <benchmark/benchmark.h>
+#include "BenchNodes.hpp"
+
+using namespace mfep::Pipeline;
+using namespace mfep::Pipeline::Bench;
+
+namespace {
+
+// Connecting a chain in creation order: every edge already agrees with the topological order.
+void BM_ConnectForward(benchmark::State& state) {
+    const auto length = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        {
+            NodeExecution exec;
+            std::vector<IncrementNode*> nodes(length);
+            for (auto*& node : nodes) {
+                node = &exec.createNode<IncrementNode>();
+            }
+            state.ResumeTiming();
+            for (size_t i = 1; i < length; ++i) {
+                nodes[i]->connect(*nodes[i - 1], 0, 0);
+            }
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * (length - 1));
+}
+BENCHMARK(BM_ConnectForward)->RangeMultiplier(8)->Range(64, 32768);
+
+// Connecting nodes against their creation order, so every connect relabels part of the graph.
+void BM_ConnectReversed(benchmark::State& state) {
+    const auto length = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        {
+            NodeExecution exec;
+            std::vector<IncrementNode*> nodes(length);
+            for (auto*& node : nodes) {
+                node = &exec.createNode<IncrementNode>();
+            }
+            state.ResumeTiming();
+            for (size_t i = 1; i < length; ++i) {
+                nodes[i - 1]->connect(*nodes[i], 0, 0);
+            }
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * (length - 1));
+}
+BENCHMARK(BM_ConnectReversed)->RangeMultiplier(4)->Range(64, 1024);
+
+void BM_BuildRandomGraph(benchmark::State& state) {
+    const auto nodeCount = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        NodeExecution exec;
+        benchmark::DoNotOptimize(buildRandom(exec, nodeCount).endNode);
+    }
+    state.SetItemsProcessed(state.iterations() * nodeCount);
+}
+BENCHMARK(BM_BuildRandomGraph)->RangeMultiplier(8)->Range(64, 32768);
+
+void BM_IsDependentOn(benchmark::State& state) {
+    const auto nodeCount = static_cast<size_t>(state.range(0));
+    NodeExecution exec;
+    const BenchGraph graph = buildRandom(exec, nodeCount);
+    std::vector<NodeBase*> nodes { graph.endNode };
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (auto* inputNode : nodes[i]->getInputNodes()) {
+            if (std::find(nodes.begin(), nodes.end(), inputNode) == nodes.end()) {
+                nodes.push_back(inputNode);
+            }
+        }
+    }
+    std::mt19937 random(7);
+    std::uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(isDependentOn(nodes[pick(random)], nodes[pick(random)]));
+    }
+}
+BENCHMARK(BM_IsDependentOn)->RangeMultiplier(8)->Range(64, 4096);
+
+}
@@ -0,0 +1,128 @@
+#include <vector>
+#include <memory>
+#include <benchmark/benchmark.h>
+#include "BenchNodes.hpp"
+
+using namespace mfep::Pipeline;
+using namespace mfep::Pipeline::Bench;
+
+namespace {
+
+struct BenchObservable : public Observable {
+    void notify() const {
+        changed();
+    }
+};
+
+class BenchObserver : public Observer {
+public:
+    size_t m_changes = 0;
+
+protected:
+    void targetChanged() override {
+        ++m_changes;
+    }
+};
+
+void BM_ObservableChanged(benchmark::State& state) {
+    const auto fanOut = static_cast<size_t>(state.range(0));
+    BenchObservable observable;
+    std::vector<BenchObserver> observers(fanOut);
+    for (auto& observer : observers) {
+        observable.attach(&observer);
+    }
+    for (auto _ : state) {
+        observable.notify();
+    }
+    state.SetItemsProcessed(state.iterations() * fanOut);
+}
+BENCHMARK(BM_ObservableChanged)->RangeMultiplier(4)->Range(1, 4096);
+
+void BM_ObservableAttachDetach(benchmark::State& state) {
+    const auto fanOut = static_cast<size_t>(state.range(0));
+    BenchObservable observable;
+    std::vector<BenchObserver> observers(fanOut);
+    for (auto _ : state) {
+        for (auto& observer : observers) {
+            observable.attach(&observer);
+        }
+        for (auto& observer : observers) {
+            observable.detach(&observer);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * fanOut);
+}
+BENCHMARK(BM_ObservableAttachDetach)->RangeMultiplier(4)->Range(1, 4096);
+
+// One source feeding a wide layer of nodes: every iteration pushes an invalidation
+// from the source through the whole fan-out, which is re-validated outside the timed region.
+void BM_FanOutInvalidation(benchmark::State& state) {
+    const auto fanOut = static_cast<size_t>(state.range(0));
+    NodeExecution exec;
+    auto& source = exec.createNode<SourceNode>();
+    std::vector<IncrementNode*> consumers(fanOut);
+    for (auto*& consumer : consumers) {
+        consumer = &exec.createNode<IncrementNode>();
+        consumer->connect(source, 0, 0);
+    }
+    for (auto* consumer : consumers) {
+        exec.execute(consumer);
+    }
+    unsigned value = 0;
+    for (auto _ : state) {
+        source.setValue(++value);
+        benchmark::DoNotOptimize(consumers.back()->isDataValid());
+        state.PauseTiming();
+        for (auto* consumer : consumers) {
+            exec.execute(consumer);
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * fanOut);
+}
+BENCHMARK(BM_FanOutInvalidation)->RangeMultiplier(4)->Range(1, 4096);
+
+// Ten sources converging into a long chain, all of them changed per iteration,
+// optionally inside a single InvalidationBatch.
+void BM_ParameterChanges(benchmark::State& state) {
+    const auto chainLength = static_cast<size_t>(state.range(0));
+    const bool batched = state.range(1) != 0;
+    NodeExecution exec;
+    std::vector<SourceNode*> sources(10);
+    NodeBase* last = nullptr;
+    for (auto*& source : sources) {
+        source = &exec.createNode<SourceNode>();
+        auto& increment = exec.createNode<IncrementNode>();
+        increment.connect(*source, 0, 0);
+        if (last != nullptr) {
+            last->connect(increment, 0, 0);
+        }
+        last = &increment;
+    }
+    for (size_t i = 0; i < chainLength; ++i) {
+        auto& increment = exec.createNode<IncrementNode>();
+        increment.connect(*last, 0, 0);
+        last = &increment;
+    }
+    exec.execute(last);
+    unsigned value = 0;
+    for (auto _ : state) {
+        ++value;
+        if (batched) {
+            InvalidationBatch batch;
+            for (auto* source : sources) {
+                source->setValue(value);
+            }
+        } else {
+            for (auto* source : sources) {
+                source->setValue(value);
+            }
+        }
+        state.PauseTiming();
+        exec.execute(last);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_ParameterChanges)->Ranges({ { 64, 4096 }, { 0, 1 } });
+
+}
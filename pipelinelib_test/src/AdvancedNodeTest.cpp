@@ -53,3 +53,82 @@ TEST_CASE("Test heap allocated type's node") {
     node2->evaluate();
     REQUIRE(node2->getData()->at(50) == 101);
 }
+class SharedHeapNode : public Node<tuple<HeapS>, tuple<HeapS>> {
+public:
+    OutData process(const InData &) const override {
+        return OutData{ getInputHandle<0>() };
+    }
+};
+
+TEST_CASE("Test shared outputs") {
+    HeapS heapS;
+    heapS.m_data.resize(100);
+    heapS.m_data[50] = 101;
+
+    HeapConstNode node1(std::move(heapS));
+    SharedHeapNode node2, node3;
+    HeapNode node4;
+    node2.connect(node1, 0, 0);
+    node3.connect(node2, 0, 0);
+    node4.connect(node3, 0, 0);
+    node1.evaluate();
+    node2.evaluate();
+    node3.evaluate();
+    node4.evaluate();
+
+    // constant and pass-through nodes forward the very same object
+    const auto* outConn1 = dynamic_cast<const OutConn<HeapS>*>(node1.getOutConn(0));
+    const auto* outConn3 = dynamic_cast<const OutConn<HeapS>*>(node3.getOutConn(0));
+    REQUIRE(&outConn1->getData() == &node1.getData());
+    REQUIRE(&outConn3->getData() == &node1.getData());
+    REQUIRE(node4.getData() == &node1.getData().m_data);
+
+    // published handles stay immutable when the constant changes
+    const auto handle = outConn3->getDataHandle();
+    HeapS newHeapS;
+    newHeapS.m_data.resize(10);
+    node1.setData(newHeapS);
+    REQUIRE(handle->m_data.size() == 100);
+    REQUIRE(node1.getData().m_data.size() == 10);
+}
+class RecyclingHeapNode : public Node<tuple<HeapS>, tuple<HeapS>> {
+public:
+    OutData process(const InData &inData) const override {
+        auto buffer = acquireOutputBuffer<0>();
+        buffer->m_data = std::get<0>(inData).m_data;
+        m_buffers.push_back(buffer.get());
+        m_vectors.push_back(buffer->m_data.data());
+        return OutData{ std::move(buffer) };
+    }
+    void invalidate() {
+        Node::invalidate();
+    }
+
+    mutable std::vector<const HeapS*> m_buffers;
+    mutable std::vector<const int*> m_vectors;
+};
+
+TEST_CASE("Test recycled output buffers") {
+    HeapS heapS;
+    heapS.m_data.resize(100);
+    heapS.m_data[50] = 101;
+
+    HeapConstNode node1(std::move(heapS));
+    RecyclingHeapNode node2;
+    node2.connect(node1, 0, 0);
+    node1.evaluate();
+    const auto* outConn = dynamic_cast<const OutConn<HeapS>*>(node2.getOutConn(0));
+    for (int i = 0; i < 6; ++i) {
+        node2.invalidate();
+        node2.evaluate();
+        REQUIRE(outConn->getData().m_data[50] == 101);
+    }
+
+    // after warming up, evaluations alternate between two buffers and reuse their storage
+    REQUIRE(node2.m_buffers[2] == node2.m_buffers[0]);
+    REQUIRE(node2.m_buffers[3] == node2.m_buffers[1]);
+    REQUIRE(node2.m_buffers[5] == node2.m_buffers[1]);
+    REQUIRE(node2.m_buffers[0] != node2.m_buffers[1]);
+    REQUIRE(node2.m_vectors[4] == node2.m_vectors[2]);
+    REQUIRE(node2.m_vectors[5] == node2.m_vectors[3]);
+}
@@ -61,3 +61,33 @@ TEST_CASE("Basic observer operation") {
     delete observable;
     REQUIRE(ss.str() == "deleted");
 }
+TEST_CASE("Observer with multiple targets") {
+    std::stringstream ss;
+    auto* observable1 = new TestObservable();
+    auto* observable2 = new TestObservable();
+    {
+        TestObserver obs(ss);
+        observable1->attach(&obs);
+        observable2->attach(&obs);
+        observable2->attach(&obs);
+
+        observable2->changed();
+        REQUIRE(ss.str() == "changedchanged");
+        ss.str("");
+
+        observable2->detach(&obs);
+        observable2->changed();
+        observable1->changed();
+        REQUIRE(ss.str() == "changedchanged");
+        ss.str("");
+
+        delete observable1;
+        REQUIRE(ss.str() == "deleted");
+        ss.str("");
+    }
+    // the observer detached itself from the remaining target on destruction
+    observable2->changed();
+    REQUIRE(ss.str().empty());
+    delete observable2;
+    REQUIRE(ss.str().empty());
+}
@@ -1,5 +1,16 @@
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <numeric>
+#include <algorithm>
 #include <sstream>
+#include <set>
+#include <condition_variable>
 #include "catch.hpp"
+#include "MapNode.hpp"
+#include "AsyncNode.hpp"
 #include "NodeStructure.hpp"
 #include "NodeAlgorithms.hpp"
 #include "NodeExecution.hpp"
@@ -57,6 +68,210 @@ class IntDistributorNode : public Node<std::tuple<int>, std::tuple<int, int, int
     }
 };
 
+class IntCountingNode : public Node<std::tuple<int>, std::tuple<int>> {
+public:
+    explicit IntCountingNode (size_t& counter) : m_counter(counter)
+    {
+    }
+
+    OutData process(const InData& input) const override {
+        ++m_counter;
+        return OutData{ std::make_unique<int>(std::get<0>(input)) };
+    }
+
+private:
+    size_t& m_counter;
+};
+
+// Records the threads evaluating it. The evaluations wait until a second thread evaluated one of
+// the nodes, or a timeout passed, so independent nodes can only finish by running concurrently.
+class ThreadRecordingNode : public Node<std::tuple<int>, std::tuple<int>> {
+public:
+    struct Record {
+        std::mutex                mutex;
+        std::condition_variable   changed;
+        std::set<std::thread::id> threads;
+    };
+
+    explicit ThreadRecordingNode (Record& record) : m_record(record)
+    {
+    }
+
+    OutData process(const InData& input) const override {
+        std::unique_lock<std::mutex> lock(m_record.mutex);
+        m_record.threads.insert(std::this_thread::get_id());
+        m_record.changed.notify_all();
+        m_record.changed.wait_for(lock, std::chrono::seconds(5), [this]{ return m_record.threads.size() > 1; });
+        return OutData{ std::make_unique<int>(std::get<0>(input)) };
+    }
+
+private:
+    Record& m_record;
+};
+
+class EvaluateCountingAddNode : public IntAddNode {
+public:
+    explicit EvaluateCountingAddNode (size_t& counter) : m_counter(counter)
+    {
+    }
+
+    void evaluate() override {
+        ++m_counter;
+        IntAddNode::evaluate();
+    }
+
+private:
+    size_t& m_counter;
+};
+
+class IntClampNode : public Node<std::tuple<int>, std::tuple<int>> {
+public:
+    IntClampNode (int low, int high) : m_low(low), m_high(high)
+    {
+    }
+
+    OutData process(const InData& input) const override {
+        return OutData{ std::make_unique<int>(std::min(std::max(std::get<0>(input), m_low), m_high)) };
+    }
+
+private:
+    int m_low, m_high;
+};
+
+class SleepingNode : public Node<std::tuple<int>, std::tuple<int>> {
+public:
+    explicit SleepingNode (std::chrono::milliseconds duration) : m_duration(duration)
+    {
+    }
+
+    OutData process(const InData& input) const override {
+        std::this_thread::sleep_for(m_duration);
+        return OutData{ std::make_unique<int>(std::get<0>(input)) };
+    }
+
+private:
+    std::chrono::milliseconds m_duration;
+};
+
+class IntScaleNode : public MapNode<int, int> {
+public:
+    IntScaleNode (int factor, size_t& counter) : m_factor(factor), m_counter(counter)
+    {
+    }
+    void setFactor (int factor) {
+        m_factor = factor;
+        invalidate();
+    }
+
+    void map(const int& in, int& out) const override {
+        ++m_counter;
+        out = in * m_factor;
+    }
+
+private:
+    int     m_factor;
+    size_t& m_counter;
+};
+
+class ToFloatMapNode : public MapNode<int, float> {
+    void map(const int& in, float& out) const override {
+        out = static_cast<float>(in);
+    }
+};
+
+// Runs callbacks after a delay on its own thread, standing in for an I/O service.
+class DelayService {
+public:
+    DelayService() : m_mostPending(0), m_stopping(false), m_thread([this]{ run(); })
+    {
+    }
+    ~DelayService() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_changed.notify_all();
+        m_thread.join();
+    }
+    void post(std::chrono::milliseconds delay, std::function<void()> callback) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.emplace_back(std::chrono::steady_clock::now() + delay, std::move(callback));
+        m_mostPending = std::max(m_mostPending, m_pending.size());
+        m_changed.notify_all();
+    }
+    // Most callbacks that waited at the same time.
+    size_t getMostPending() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_mostPending;
+    }
+
+private:
+    using Pending = std::pair<std::chrono::steady_clock::time_point, std::function<void()>>;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stopping || !m_pending.empty()) {
+            if (m_pending.empty()) {
+                m_changed.wait(lock);
+                continue;
+            }
+            auto next = std::min_element(m_pending.begin(), m_pending.end(), [](const Pending& lhs, const Pending& rhs){
+                return lhs.first < rhs.first;
+            });
+            const auto deadline = next->first;
+            if (std::chrono::steady_clock::now() < deadline) {
+                m_changed.wait_until(lock, deadline);
+                continue;
+            }
+            auto callback = std::move(next->second);
+            m_pending.erase(next);
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+
+    std::mutex              m_mutex;
+    std::condition_variable m_changed;
+    std::vector<Pending>    m_pending;
+    size_t                  m_mostPending;
+    bool                    m_stopping;
+    std::thread             m_thread;
+};
+
+// Increments its input after waiting on the service, fails on negative inputs.
+class DelayedIncrementNode : public AsyncNode<std::tuple<int>, std::tuple<int>> {
+public:
+    DelayedIncrementNode (DelayService& service, std::chrono::milliseconds delay) : m_service(service), m_delay(delay)
+    {
+    }
+
+    void processAsync(const InData& input, Completion completion) const override {
+        const int value = std::get<0>(input);
+        m_service.post(m_delay, [value, completion]{
+            if (value < 0) {
+                completion.fail(std::make_exception_ptr(PIPELINE_EXCEPTION("Negative input")));
+            } else {
+                completion.complete(OutData{ std::make_unique<int>(value + 1) });
+            }
+        });
+    }
+
+private:
+    DelayService&             m_service;
+    std::chrono::milliseconds m_delay;
+};
+
+// Reports its result right away, then reports again and throws, which are both ignored.
+class OverreportingNode : public AsyncNode<std::tuple<int>, std::tuple<int>> {
+public:
+    void processAsync(const InData& input, Completion completion) const override {
+        completion.complete(OutData{ std::make_unique<int>(std::get<0>(input) * 2) });
+        completion.fail(std::make_exception_ptr(PIPELINE_EXCEPTION("Reported twice")));
+        throw PIPELINE_EXCEPTION("Thrown after reporting");
+    }
+};
+
 TEST_CASE("Node operation on simple types") {
     IntDistributorNode dist;
     NodeExecution exec;
@@ -218,3 +433,710 @@ TEST_CASE("Changing nodes") {
     exec.execute(&printer);
     REQUIRE(ss.str() == "5");
 }
+TEST_CASE("Parallel execution") {
+    NodeExecution exec(4);
+    REQUIRE(exec.getThreadCount() == 4);
+    REQUIRE_THROWS_AS(NodeExecution(0), PipelineException);
+
+    const size_t n = 1024;
+    std::vector<NodeBase*> addNodes(n);
+    auto& sum = exec.registerNode(std::make_unique<ConstIntNode>(0));
+    NodeBase* last = &sum;
+    for (size_t i = 0; i < n; ++i) {
+        auto& constNode = exec.registerNode(std::make_unique<ConstIntNode>(1));
+        addNodes[i] = &exec.registerNode(std::make_unique<IntAddNode>());
+        addNodes[i]->connect(*last, 0, 0);
+        addNodes[i]->connect(constNode, 1, 0);
+        last = addNodes[i];
+    }
+    std::stringstream ss;
+    auto& printer = exec.registerNode(std::make_unique<IntPrinterNode>(ss));
+    printer.connect(*last, 0, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "1024");
+
+    sum.setValue(10);
+    ss.str("");
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "1034");
+
+    // independent nodes are picked up by several workers
+    ThreadRecordingNode::Record record;
+    auto& source = exec.createNode<ConstIntNode>(1);
+    std::vector<NodeBase*> level;
+    for (size_t i = 0; i < 64; ++i) {
+        level.push_back(&exec.createNode<ThreadRecordingNode>(record));
+        level.back()->connect(source, 0, 0);
+    }
+    while (level.size() > 1) {
+        std::vector<NodeBase*> nextLevel;
+        for (size_t i = 0; i < level.size(); i += 2) {
+            auto& add = exec.createNode<IntAddNode>();
+            add.connect(*level[i], 0, 0);
+            add.connect(*level[i + 1], 1, 0);
+            nextLevel.push_back(&add);
+        }
+        level.swap(nextLevel);
+    }
+    auto& widePrinter = exec.createNode<IntPrinterNode>(ss);
+    widePrinter.connect(*level[0], 0, 0);
+    ss.str("");
+    exec.execute(&widePrinter);
+    REQUIRE(ss.str() == "64");
+    REQUIRE(record.threads.size() > 1);
+
+    // exceptions of worker threads are rethrown on the calling thread
+    auto& unconnected = exec.registerNode(std::make_unique<IntAddNode>());
+    printer.connect(unconnected, 0, 0);
+    REQUIRE_THROWS_AS(exec.execute(&printer), PipelineException);
+}
+TEST_CASE("Diamond-shaped execution") {
+    NodeExecution exec;
+    size_t processCount = 0;
+    const size_t levels = 16;
+
+    NodeBase* last = &exec.registerNode(std::make_unique<ConstIntNode>(1));
+    for (size_t i = 0; i < levels; ++i) {
+        auto& left = exec.registerNode(std::make_unique<IntCountingNode>(processCount));
+        auto& right = exec.registerNode(std::make_unique<IntCountingNode>(processCount));
+        auto& add = exec.registerNode(std::make_unique<IntAddNode>());
+        left.connect(*last, 0, 0);
+        right.connect(*last, 0, 0);
+        add.connect(left, 0, 0);
+        add.connect(right, 1, 0);
+        last = &add;
+    }
+    std::stringstream ss;
+    auto& printer = exec.registerNode(std::make_unique<IntPrinterNode>(ss));
+    printer.connect(*last, 0, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "65536");
+    REQUIRE(processCount == 2 * levels);
+}
+TEST_CASE("Changing topology between executions") {
+    NodeExecution exec;
+    auto& n1 = exec.registerNode(std::make_unique<ConstIntNode>(1));
+    auto& n2 = exec.registerNode(std::make_unique<ConstIntNode>(3));
+    auto& n3 = exec.registerNode(std::make_unique<ConstIntNode>(10));
+    auto& add = exec.registerNode(std::make_unique<IntAddNode>());
+    std::stringstream ss;
+    auto& printer = exec.registerNode(std::make_unique<IntPrinterNode>(ss));
+
+    add.connect(n1, 0, 0);
+    add.connect(n2, 1, 0);
+    printer.connect(add, 0, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "4");
+
+    ss.str("");
+    add.connect(n3, 1, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "11");
+
+    ss.str("");
+    printer.disconnect(0);
+    printer.connect(n2, 0, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "3");
+}
+TEST_CASE("Cached plans") {
+    NodeExecution exec;
+    auto& n1 = exec.createNode<ConstIntNode>(1);
+    auto& n2 = exec.createNode<ConstIntNode>(2);
+    auto& add = exec.createNode<IntAddNode>();
+    std::stringstream ss;
+    auto& printer = exec.createNode<IntPrinterNode>(ss);
+    add.connect(n1, 0, 0);
+    add.connect(n2, 1, 0);
+    printer.connect(add, 0, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "3");
+
+    // edges outside of the plan, here in another graph, don't affect it
+    {
+        ConstIntNode other(5);
+        IntAddNode otherAdd;
+        otherAdd.connect(other, 0, 0);
+        otherAdd.connect(other, 1, 0);
+        n1.setValue(4);
+        ss.str("");
+        exec.execute(&printer);
+        REQUIRE(ss.str() == "6");
+    }
+
+    // the plan of a destroyed end node is dropped, and nodes it contained are destroyed before it
+    for (int round = 0; round < 2; ++round) {
+        auto source = std::make_unique<ConstIntNode>(round);
+        auto endNode = std::make_unique<IntAddNode>();
+        endNode->connect(*source, 0, 0);
+        endNode->connect(n2, 1, 0);
+        exec.execute(endNode.get());
+        source.reset();
+        endNode.reset();
+    }
+    ss.str("");
+    n2.setValue(10);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "14");
+}
+TEST_CASE("Topological order maintenance") {
+    std::stringstream ss;
+    IntPrinterNode p1(ss), p2(ss), p3(ss);
+    ConstIntNode n(7);
+
+    // connect against the creation order to force relabeling
+    p1.connect(p3, 0, 0);
+    p3.connect(p2, 0, 0);
+    p2.connect(n, 0, 0);
+    REQUIRE(n.getTopologicalOrder() < p2.getTopologicalOrder());
+    REQUIRE(p2.getTopologicalOrder() < p3.getTopologicalOrder());
+    REQUIRE(p3.getTopologicalOrder() < p1.getTopologicalOrder());
+    REQUIRE(isDependentOn(&n, &p1));
+    REQUIRE(isDependentOn(&p2, &p1));
+    REQUIRE_FALSE(isDependentOn(&p1, &p2));
+    REQUIRE(p2.getOutputNodes() == std::vector<NodeBase*>{ &p3 });
+
+    REQUIRE_THROWS_AS(p2.connect(p1, 0, 0), PipelineException);
+    REQUIRE_THROWS_AS(p2.connect(p2, 0, 0), PipelineException);
+    REQUIRE(isDependentOn(&n, &p1));
+
+    p3.disconnect(0);
+    REQUIRE_FALSE(isDependentOn(&n, &p1));
+    REQUIRE(p2.getOutputNodes().empty());
+    REQUIRE_NOTHROW(p2.connect(p1, 0, 0));
+    REQUIRE(isDependentOn(&p3, &p2));
+    REQUIRE(p1.getTopologicalOrder() < p2.getTopologicalOrder());
+}
+TEST_CASE("Dirty-only re-execution") {
+    NodeExecution exec;
+    size_t evaluateCount = 0;
+    const size_t n = 1000;
+    std::vector<ConstIntNode*> constNodes(n);
+    NodeBase* last = &exec.registerNode(std::make_unique<ConstIntNode>(0));
+    for (size_t i = 0; i < n; ++i) {
+        constNodes[i] = &exec.registerNode(std::make_unique<ConstIntNode>(1));
+        auto& add = exec.registerNode(std::make_unique<EvaluateCountingAddNode>(evaluateCount));
+        add.connect(*last, 0, 0);
+        add.connect(*constNodes[i], 1, 0);
+        last = &add;
+    }
+    std::stringstream ss;
+    auto& printer = exec.registerNode(std::make_unique<IntPrinterNode>(ss));
+    printer.connect(*last, 0, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "1000");
+    REQUIRE(evaluateCount == n);
+
+    evaluateCount = 0;
+    exec.execute(&printer);
+    REQUIRE(evaluateCount == 0);
+
+    ss.str("");
+    constNodes[n - 10]->setValue(11);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "1010");
+    REQUIRE(evaluateCount == 10);
+}
+TEST_CASE("Early cutoff") {
+    NodeExecution exec;
+    size_t processCount = 0;
+    auto& n = exec.registerNode(std::make_unique<ConstIntNode>(20));
+    auto& clamp = exec.registerNode(std::make_unique<IntClampNode>(0, 10));
+    auto& counter = exec.registerNode(std::make_unique<IntCountingNode>(processCount));
+    std::stringstream ss;
+    auto& printer = exec.registerNode(std::make_unique<IntPrinterNode>(ss));
+    clamp.connect(n, 0, 0);
+    counter.connect(clamp, 0, 0);
+    printer.connect(counter, 0, 0);
+
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "10");
+    REQUIRE(processCount == 1);
+
+    // without cutoff every change reaches the end of the graph
+    n.setValue(30);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "1010");
+    REQUIRE(processCount == 2);
+
+    clamp.enableEarlyCutoff<0>();
+    n.setValue(40);
+    REQUIRE_FALSE(printer.isDataValid());
+    exec.execute(&printer);
+    REQUIRE(printer.isDataValid());
+    REQUIRE(ss.str() == "1010");
+    REQUIRE(processCount == 2);
+
+    n.setValue(5);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "10105");
+    REQUIRE(processCount == 3);
+}
+TEST_CASE("Arena allocated nodes") {
+    struct CountedConstIntNode : public ConstIntNode {
+        CountedConstIntNode(int value, size_t& counter) : ConstIntNode(value), m_counter(counter) {}
+        ~CountedConstIntNode() override { ++m_counter; }
+        size_t& m_counter;
+    };
+
+    size_t destroyedCount = 0;
+    std::stringstream ss;
+    {
+        NodeExecution exec;
+        size_t n = 4096;
+        std::vector<NodeBase*> nodes(n);
+        for (size_t i = 0; i < n; ++i) {
+            nodes[i] = &exec.createNode<CountedConstIntNode>(1, destroyedCount);
+        }
+        while (n > 1) {
+            n /= 2;
+            for (size_t i = 0; i < n; ++i) {
+                auto& add = exec.createNode<IntAddNode>();
+                add.connect(*nodes[2*i], 0, 0);
+                add.connect(*nodes[2*i+1], 1, 0);
+                nodes[i] = &add;
+            }
+        }
+        auto& printer = exec.createNode<IntPrinterNode>(ss);
+        auto& registeredPrinter = exec.registerNode(std::make_unique<IntPrinterNode>(ss));
+        printer.connect(*nodes[0], 0, 0);
+        registeredPrinter.connect(printer, 0, 0);
+        exec.execute(&registeredPrinter);
+    }
+    REQUIRE(ss.str() == "40964096");
+    REQUIRE(destroyedCount == 4096);
+}
+TEST_CASE("Deep chain execution") {
+    NodeExecution exec;
+    const size_t n = 65536;
+    auto& source = exec.createNode<ConstIntNode>(0);
+    NodeBase* last = &source;
+    for (size_t i = 0; i < n; ++i) {
+        auto& add = exec.createNode<IntAddNode>();
+        add.connect(*last, 0, 0);
+        add.connect(source, 1, 0);
+        last = &add;
+    }
+    std::stringstream ss;
+    auto& printer = exec.createNode<IntPrinterNode>(ss);
+    printer.connect(*last, 0, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "0");
+
+    ss.str("");
+    source.setValue(1);
+    REQUIRE_FALSE(printer.isDataValid());
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "65537");
+}
+TEST_CASE("Batched invalidation") {
+    NodeExecution exec;
+    auto& n1 = exec.createNode<ConstIntNode>(1);
+    auto& n2 = exec.createNode<ConstIntNode>(3);
+    auto& add = exec.createNode<IntAddNode>();
+    std::stringstream ss;
+    auto& printer = exec.createNode<IntPrinterNode>(ss);
+    add.connect(n1, 0, 0);
+    add.connect(n2, 1, 0);
+    printer.connect(add, 0, 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "4");
+
+    ss.str("");
+    {
+        InvalidationBatch batch;
+        n1.setValue(10);
+        {
+            InvalidationBatch nestedBatch;
+            n2.setValue(20);
+        }
+        REQUIRE_FALSE(n1.isDataValid());
+        REQUIRE_FALSE(n2.isDataValid());
+        REQUIRE(printer.isDataValid());
+        // the printer would be served with its stale output
+        REQUIRE_THROWS_AS(exec.execute(&printer), PipelineException);
+    }
+    REQUIRE_FALSE(add.isDataValid());
+    REQUIRE_FALSE(printer.isDataValid());
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "30");
+}
+TEST_CASE("Execution profiling") {
+    NodeExecution exec;
+    auto& n1 = exec.createNode<ConstIntNode>(20);
+    auto& n2 = exec.createNode<ConstIntNode>(1);
+    auto& add = exec.createNode<IntAddNode>();
+    auto& clamp = exec.createNode<IntClampNode>(0, 10);
+    std::stringstream ss;
+    auto& printer = exec.createNode<IntPrinterNode>(ss);
+    add.connect(n1, 0, 0);
+    add.connect(n2, 1, 0);
+    clamp.connect(add, 0, 0);
+    printer.connect(clamp, 0, 0);
+    clamp.enableEarlyCutoff<0>();
+
+    exec.execute(&printer);
+    REQUIRE(exec.getProfiles(&printer).empty());
+    REQUIRE(printer.getProfile() == nullptr);
+
+    exec.setProfilingEnabled(true);
+    n1.setValue(30);
+    exec.execute(&printer);
+    auto profiles = exec.getProfiles(&printer);
+    REQUIRE(profiles.size() == 5);
+    REQUIRE(profiles.back().first == &printer);
+    for (const auto& profile : profiles) {
+        const bool evaluated = profile.first != &n2;
+        REQUIRE(profile.second.evaluations == (evaluated ? 1 : 0));
+        REQUIRE(profile.second.cacheHits == (evaluated ? 0 : 1));
+        REQUIRE(profile.second.wallTime >= profile.second.processTime);
+    }
+    REQUIRE(n1.getProfile()->processCalls == 1);
+    REQUIRE(n1.getProfile()->outputBytes == sizeof(int));
+    REQUIRE(clamp.getProfile()->processCalls == 1);
+    REQUIRE(printer.getProfile()->reuses == 1);
+    REQUIRE(printer.getProfile()->processCalls == 0);
+
+    exec.execute(&printer);
+    REQUIRE(printer.getProfile()->cacheHits == 1);
+    REQUIRE(printer.getProfile()->evaluations == 1);
+
+    exec.setProfilingEnabled(false);
+    exec.execute(&printer);
+    REQUIRE(exec.getProfiles(&printer).empty());
+    REQUIRE(n1.getProfile() == nullptr);
+    REQUIRE(ss.str() == "10");
+
+    // a valid node serving several evaluated nodes counts one cache hit per execution
+    auto& left = exec.createNode<IntAddNode>();
+    auto& right = exec.createNode<IntAddNode>();
+    auto& top = exec.createNode<IntAddNode>();
+    left.connect(n1, 0, 0);
+    left.connect(n2, 1, 0);
+    right.connect(n2, 0, 0);
+    right.connect(n1, 1, 0);
+    top.connect(left, 0, 0);
+    top.connect(right, 1, 0);
+    exec.setProfilingEnabled(true);
+    exec.execute(&top);
+    REQUIRE(n1.getProfile()->cacheHits == 1);
+    REQUIRE(n2.getProfile()->cacheHits == 1);
+    REQUIRE(left.getProfile()->evaluations == 1);
+}
+TEST_CASE("Execution trace") {
+    const auto countOccurrences = [](const std::string& text, const std::string& pattern) {
+        size_t count = 0;
+        for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            ++count;
+        }
+        return count;
+    };
+
+    NodeExecution exec(2);
+    auto& n1 = exec.createNode<ConstIntNode>(1);
+    auto& n2 = exec.createNode<ConstIntNode>(2);
+    auto& add = exec.createNode<IntAddNode>();
+    std::stringstream ss;
+    auto& printer = exec.createNode<IntPrinterNode>(ss);
+    add.connect(n1, 0, 0);
+    add.connect(n2, 1, 0);
+    printer.connect(add, 0, 0);
+    n1.setName("first \"constant\"");
+    REQUIRE_THROWS_AS(exec.writeTrace(ss), PipelineException);
+
+    exec.startTrace();
+    exec.execute(&printer);
+    n2.setValue(3);
+    exec.execute(&printer);
+    exec.stopTrace();
+    n2.setValue(4);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "345");
+
+    std::stringstream trace;
+    exec.writeTrace(trace);
+    const std::string json = trace.str();
+    REQUIRE(countOccurrences(json, "\"ph\":\"X\"") == 7);
+    // n1 -> add, n2 -> add, add -> printer in the first execution, n2 -> add, add -> printer in the
+    // second: n1 stayed valid, and spans of different executions aren't connected
+    REQUIRE(countOccurrences(json, "\"ph\":\"s\"") == 5);
+    REQUIRE(countOccurrences(json, "\"ph\":\"f\"") == 5);
+    REQUIRE(countOccurrences(json, "\"name\":\"first \\\"constant\\\"\"") == 1);
+    REQUIRE(countOccurrences(json, "\"name\":\"IntAddNode\"") == 2);
+    REQUIRE(countOccurrences(json, "\"type\":\"ConstIntNode\"") == 3);
+}
+TEST_CASE("Critical path and makespan estimation") {
+    using std::chrono::milliseconds;
+    NodeExecution exec(2);
+    auto& source = exec.createNode<ConstIntNode>(1);
+    auto& heavy = exec.createNode<SleepingNode>(milliseconds(40));
+    heavy.connect(source, 0, 0);
+    NodeBase* light = &source;
+    for (size_t i = 0; i < 4; ++i) {
+        auto& node = exec.createNode<SleepingNode>(milliseconds(5));
+        node.connect(*light, 0, 0);
+        light = &node;
+    }
+    auto& add = exec.createNode<IntAddNode>();
+    add.connect(heavy, 0, 0);
+    add.connect(*light, 1, 0);
+    std::stringstream ss;
+    auto& printer = exec.createNode<IntPrinterNode>(ss);
+    printer.connect(add, 0, 0);
+
+    REQUIRE(exec.estimateMakespan(&printer, 1).count() == 0);
+    exec.execute(&printer);
+    REQUIRE(ss.str() == "2");
+
+    const auto criticalPath = exec.getCriticalPath(&printer);
+    REQUIRE(criticalPath == std::vector<const NodeBase*>{ &source, &heavy, &add, &printer });
+    const auto serial = exec.estimateMakespan(&printer, 1);
+    const auto parallel = exec.estimateMakespan(&printer, 2);
+    REQUIRE(serial >= milliseconds(60));
+    REQUIRE(parallel >= milliseconds(40));
+    REQUIRE(parallel < serial);
+    REQUIRE(exec.estimateMakespan(&printer, 8) == parallel);
+    REQUIRE_THROWS_AS(exec.estimateMakespan(&printer, 0), PipelineException);
+}
+TEST_CASE("Parallel reduction tree") {
+    NodeExecution exec(4);
+    const size_t n = 4096;
+    std::vector<ConstIntNode*> sources(n);
+    std::vector<NodeBase*> level(n);
+    for (size_t i = 0; i < n; ++i) {
+        sources[i] = &exec.createNode<ConstIntNode>(1);
+        level[i] = sources[i];
+    }
+    while (level.size() > 1) {
+        std::vector<NodeBase*> next(level.size() / 2);
+        for (size_t i = 0; i < next.size(); ++i) {
+            auto& add = exec.createNode<IntAddNode>();
+            add.connect(*level[2*i], 0, 0);
+            add.connect(*level[2*i+1], 1, 0);
+            next[i] = &add;
+        }
+        level = std::move(next);
+    }
+    std::stringstream ss;
+    auto& printer = exec.createNode<IntPrinterNode>(ss);
+    printer.connect(*level[0], 0, 0);
+
+    std::vector<int> values(n, 1);
+    for (int round = 0; round < 16; ++round) {
+        exec.execute(&printer);
+        REQUIRE(ss.str() == std::to_string(std::accumulate(values.begin(), values.end(), 0)));
+        ss.str("");
+        InvalidationBatch batch;
+        for (size_t i = round; i < n; i += 7 + round) {
+            values[i] = round;
+            sources[i]->setValue(round);
+        }
+    }
+}
+
+TEST_CASE("Asynchronous execution") {
+    using namespace std::chrono;
+    for (size_t threadCount : { 1, 4 }) {
+        NodeExecution exec(threadCount);
+        std::stringstream ss;
+        auto& source = exec.createNode<ConstIntNode>(3);
+        NodeBase* last = &source;
+        for (int i = 0; i < 4; ++i) {
+            auto& node = exec.createNode<SleepingNode>(milliseconds(20));
+            node.connect(*last, 0, 0);
+            last = &node;
+        }
+        auto& printer = exec.createNode<IntPrinterNode>(ss);
+        printer.connect(*last, 0, 0);
+
+        SECTION("Completion") {
+            std::atomic<int> callbacks(0);
+            std::promise<ExecutionHandle::Status> completed;
+            ExecutionHandle handle = exec.executeAsync(&printer);
+            handle.onComplete([&callbacks, &completed](ExecutionHandle::Status status){
+                ++callbacks;
+                completed.set_value(status);
+            });
+            REQUIRE_THROWS_AS(exec.execute(&printer), PipelineException);
+            REQUIRE_THROWS_AS(exec.executeAsync(&printer), PipelineException);
+            // the running execution uses the costs and priorities of the plan
+            REQUIRE_THROWS_AS(exec.getCriticalPath(&printer), PipelineException);
+            REQUIRE_THROWS_AS(exec.estimateMakespan(&printer, 2), PipelineException);
+            REQUIRE_THROWS_AS(exec.getProfiles(&printer), PipelineException);
+            handle.get();
+            REQUIRE(exec.getCriticalPath(&printer).size() == 6);
+            REQUIRE(handle.getStatus() == ExecutionHandle::Status::Completed);
+            REQUIRE(ss.str() == "3");
+            REQUIRE(completed.get_future().get() == ExecutionHandle::Status::Completed);
+            handle.onComplete([&callbacks](ExecutionHandle::Status){ ++callbacks; });
+            REQUIRE(callbacks == 2);
+
+            // nothing to evaluate, done right away
+            REQUIRE(exec.executeAsync(&printer).isDone());
+        }
+
+        SECTION("Callbacks waiting and chaining") {
+            std::promise<ExecutionHandle::Status> waited;
+            std::promise<ExecutionHandle> chained;
+            ExecutionHandle handle = exec.executeAsync(&printer);
+            handle.onComplete([&handle, &waited](ExecutionHandle::Status){
+                handle.wait();
+                waited.set_value(handle.getStatus());
+            });
+            handle.onComplete([&exec, &source, &printer, &chained](ExecutionHandle::Status){
+                source.setValue(5);
+                chained.set_value(exec.executeAsync(&printer));
+            });
+            REQUIRE(waited.get_future().get() == ExecutionHandle::Status::Completed);
+            ExecutionHandle next = chained.get_future().get();
+            next.get();
+            REQUIRE(ss.str() == "35");
+        }
+
+        SECTION("Cancellation") {
+            ExecutionHandle handle = exec.executeAsync(&printer);
+            handle.cancel();
+            REQUIRE_THROWS_AS(handle.get(), PipelineException);
+            REQUIRE(handle.getStatus() == ExecutionHandle::Status::Cancelled);
+            REQUIRE(!printer.isDataValid());
+            REQUIRE(ss.str().empty());
+
+            // the skipped nodes run on the next execution
+            exec.execute(&printer);
+            REQUIRE(ss.str() == "3");
+        }
+    }
+}
+
+TEST_CASE("Asynchronous nodes") {
+    using namespace std::chrono;
+    for (size_t threadCount : { 1, 2 }) {
+        DelayService service;
+        NodeExecution exec(threadCount);
+        std::stringstream ss;
+        auto& source = exec.createNode<ConstIntNode>(1);
+        std::vector<DelayedIncrementNode*> delayed;
+        for (int i = 0; i < 4; ++i) {
+            delayed.push_back(&exec.createNode<DelayedIncrementNode>(service, milliseconds(60)));
+            delayed.back()->connect(source, 0, 0);
+        }
+        auto& left = exec.createNode<IntAddNode>();
+        left.connect(*delayed[0], 0, 0);
+        left.connect(*delayed[1], 1, 0);
+        auto& right = exec.createNode<IntAddNode>();
+        right.connect(*delayed[2], 0, 0);
+        right.connect(*delayed[3], 1, 0);
+        auto& sum = exec.createNode<IntAddNode>();
+        sum.connect(left, 0, 0);
+        sum.connect(right, 1, 0);
+        auto& printer = exec.createNode<IntPrinterNode>(ss);
+        printer.connect(sum, 0, 0);
+
+        // the workers don't wait for the nodes, all of them wait at the same time
+        exec.executeAsync(&printer).get();
+        REQUIRE(service.getMostPending() == 4);
+        REQUIRE(ss.str() == "8");
+        ss.str("");
+
+        // evaluated in place by a serial execution
+        if (threadCount == 1) {
+            source.setValue(2);
+            exec.execute(&printer);
+            REQUIRE(ss.str() == "12");
+            ss.str("");
+        }
+
+        source.setValue(-1);
+        REQUIRE_THROWS_AS(exec.execute(&printer), PipelineException);
+        REQUIRE(ss.str().empty());
+        REQUIRE_FALSE(printer.isDataValid());
+
+        // only the first report of a node counts
+        auto& overreporting = exec.createNode<OverreportingNode>();
+        auto& overreportingPrinter = exec.createNode<IntPrinterNode>(ss);
+        overreporting.connect(source, 0, 0);
+        overreportingPrinter.connect(overreporting, 0, 0);
+        exec.execute(&overreportingPrinter);
+        REQUIRE(ss.str() == "-2");
+        ss.str("");
+        source.setValue(4);
+        exec.executeAsync(&overreportingPrinter).get();
+        REQUIRE(ss.str() == "8");
+    }
+}
+
+TEST_CASE("Fused chains") {
+    for (size_t threadCount : { 1, 2 }) {
+        NodeExecution exec(threadCount);
+        exec.setFusionEnabled(true);
+        size_t mapCount = 0;
+        auto& source = exec.createNode<ConstIntNode>(2);
+        auto& triple = exec.createNode<IntScaleNode>(3, mapCount);
+        auto& scale = exec.createNode<IntScaleNode>(5, mapCount);
+        auto& toFloat = exec.createNode<ToFloatMapNode>();
+        triple.connect(source, 0, 0);
+        scale.connect(triple, 0, 0);
+        toFloat.connect(scale, 0, 0);
+        const auto* result = dynamic_cast<const OutConn<float>*>(toFloat.getOutConn(0));
+
+        exec.execute(&toFloat);
+        REQUIRE(result->getData() == 30.f);
+        REQUIRE(mapCount == 2);
+        // only the end of the chain publishes its output
+        REQUIRE(triple.isDataValid());
+        REQUIRE(triple.isOutputElided());
+        REQUIRE_FALSE(triple.getOutConn(0)->isDataAvailable());
+        REQUIRE_FALSE(scale.getOutConn(0)->isDataAvailable());
+        exec.execute(&toFloat);
+        REQUIRE(mapCount == 2);
+
+        // the chain resumes at the node that changed, with the value kept by the one before
+        scale.setFactor(7);
+        exec.execute(&toFloat);
+        REQUIRE(result->getData() == 42.f);
+        REQUIRE(mapCount == 3);
+        source.setValue(1);
+        exec.execute(&toFloat);
+        REQUIRE(result->getData() == 21.f);
+        REQUIRE(mapCount == 5);
+
+        // without fusion the kept back outputs are published again when needed, without mapping
+        exec.setFusionEnabled(false);
+        scale.setFactor(2);
+        exec.execute(&toFloat);
+        REQUIRE(result->getData() == 6.f);
+        REQUIRE(mapCount == 6);
+        REQUIRE(triple.getOutConn(0)->isDataAvailable());
+        REQUIRE_FALSE(triple.isOutputElided());
+
+        // a node with another consumer keeps its output
+        exec.setFusionEnabled(true);
+        std::stringstream ss;
+        auto& printer = exec.createNode<IntPrinterNode>(ss);
+        printer.connect(triple, 0, 0);
+        source.setValue(4);
+        exec.execute(&toFloat);
+        exec.execute(&printer);
+        REQUIRE(result->getData() == 24.f);
+        REQUIRE(ss.str() == "12");
+        REQUIRE(triple.getOutConn(0)->isDataAvailable());
+        REQUIRE_FALSE(scale.getOutConn(0)->isDataAvailable());
+
+        // a node keeping the same value stops the mapping along the chain
+        size_t cutoffCount = 0;
+        auto& zero = exec.createNode<IntScaleNode>(0, cutoffCount);
+        auto& afterZero = exec.createNode<IntScaleNode>(5, cutoffCount);
+        auto& zeroToFloat = exec.createNode<ToFloatMapNode>();
+        zero.enableEarlyCutoff<0>();
+        zero.connect(source, 0, 0);
+        afterZero.connect(zero, 0, 0);
+        zeroToFloat.connect(afterZero, 0, 0);
+        exec.execute(&zeroToFloat);
+        REQUIRE(cutoffCount == 2);
+        source.setValue(5);
+        exec.execute(&zeroToFloat);
+        REQUIRE(cutoffCount == 3);
+        REQUIRE(afterZero.isDataValid());
+        REQUIRE(dynamic_cast<const OutConn<float>*>(zeroToFloat.getOutConn(0))->getData() == 0.f);
+    }
+}
@@ -0,0 +1,77 @@
+#include "catch.hpp"
+#include "MapNode.hpp"
+#include "StaticGraph.hpp"
+
+using namespace mfep::Pipeline;
+
+namespace {
+
+class ValueNode : public Node<std::tuple<>, std::tuple<int>> {
+public:
+    explicit ValueNode(int value) : m_value(value)
+    {
+    }
+    void setValue(int value) {
+        m_value = value;
+    }
+    OutData process(const InData&) const override {
+        return OutData{ std::make_unique<int>(m_value) };
+    }
+
+private:
+    int m_value;
+};
+
+class AddNode : public Node<std::tuple<int, int>, std::tuple<int>> {
+public:
+    OutData process(const InData& input) const override {
+        return OutData{ std::make_unique<int>(std::get<0>(input) + std::get<1>(input)) };
+    }
+};
+
+// Keeps process() private, the graph calls it through the Node it derives from.
+class SplitNode : public Node<std::tuple<int>, std::tuple<int, float>> {
+    OutData process(const InData& input) const override {
+        const int value = std::get<0>(input);
+        return OutData{ std::make_unique<int>(-value), std::make_unique<float>(value * 0.5f) };
+    }
+};
+
+class DoubleNode : public MapNode<float, float> {
+public:
+    void map(const float& in, float& out) const override {
+        out = in * 2;
+    }
+};
+
+}
+
+TEST_CASE("Static graph") {
+    using Graph = StaticGraph<
+        StaticNode<ValueNode>,
+        StaticNode<ValueNode>,
+        StaticNode<AddNode, From<0>, From<1>>,
+        StaticNode<SplitNode, From<2>>,
+        StaticNode<DoubleNode, From<3, 1>>,
+        StaticNode<AddNode, From<3>, From<0>>>;
+    static_assert(std::is_same<Graph::OutType<3, 1>, float>::value, "SplitNode's second output is a float");
+
+    Graph graph(std::make_tuple(3), std::make_tuple(4), std::tuple<>(), std::tuple<>(), std::tuple<>(), std::tuple<>());
+    REQUIRE_THROWS_AS(graph.get<2>(), PipelineException);
+    graph.run();
+    REQUIRE(graph.get<2>() == 7);
+    REQUIRE(graph.get<3, 0>() == -7);
+    REQUIRE(graph.get<3, 1>() == 3.5f);
+    REQUIRE(graph.get<4>() == 7.f);
+    REQUIRE(graph.get<5>() == -4);
+
+    // every run evaluates every node
+    graph.getNode<1>().setValue(10);
+    graph.run();
+    REQUIRE(graph.get<2>() == 13);
+    REQUIRE(graph.get<4>() == 13.f);
+    REQUIRE(graph.get<5>() == -10);
+
+    // the nodes of the graph aren't connected to each other
+    REQUIRE_FALSE(graph.getNode<2>().isConnected());
+}
@@ -0,0 +1,464 @@
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include "catch.hpp"
+#include "BatchNode.hpp"
+#include "RingBuffer.hpp"
+#include "StreamSource.hpp"
+#include "StreamExecution.hpp"
+
+using namespace mfep::Pipeline;
+
+namespace {
+
+class ConstantNode : public Node<std::tuple<>, std::tuple<int>> {
+public:
+    OutData process(const InData&) const override {
+        return OutData{ std::make_unique<int>(1) };
+    }
+};
+
+class SquareNode : public Node<std::tuple<int>, std::tuple<int>> {
+public:
+    OutData process(const InData& input) const override {
+        const int value = std::get<0>(input);
+        return OutData{ std::make_unique<int>(value * value) };
+    }
+};
+
+class SubtractNode : public Node<std::tuple<int, int>, std::tuple<int>> {
+public:
+    OutData process(const InData& input) const override {
+        return OutData{ std::make_unique<int>(std::get<0>(input) - std::get<1>(input)) };
+    }
+};
+
+// Forwards its input without copying it.
+class ForwardNode : public Node<std::tuple<std::vector<int>>, std::tuple<std::vector<int>>> {
+public:
+    OutData process(const InData&) const override {
+        return OutData{ getInputHandle<0>() };
+    }
+};
+
+class SlowNode : public Node<std::tuple<int>, std::tuple<int>> {
+public:
+    OutData process(const InData& input) const override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return OutData{ std::make_unique<int>(std::get<0>(input)) };
+    }
+};
+
+// Records the most nodes running process() at the same time.
+class OverlapNode : public SlowNode {
+public:
+    OverlapNode(std::atomic<int>& running, std::atomic<int>& mostRunning) : m_running(running), m_mostRunning(mostRunning)
+    {
+    }
+    OutData process(const InData& input) const override {
+        const int running = ++m_running;
+        int mostRunning = m_mostRunning.load();
+        while (running > mostRunning && !m_mostRunning.compare_exchange_weak(mostRunning, running)) {
+        }
+        auto outData = SlowNode::process(input);
+        --m_running;
+        return outData;
+    }
+
+private:
+    std::atomic<int>& m_running;
+    std::atomic<int>& m_mostRunning;
+};
+
+class FailingNode : public Node<std::tuple<int>, std::tuple<int>> {
+public:
+    OutData process(const InData& input) const override {
+        if (std::get<0>(input) == 3) {
+            throw PIPELINE_EXCEPTION("Failing on three");
+        }
+        return OutData{ std::make_unique<int>(std::get<0>(input)) };
+    }
+};
+
+// Adds and subtracts its inputs a batch at a time, and records the size of every batch.
+class BatchAddNode : public BatchNode<std::tuple<int, int>, std::tuple<int, int>> {
+public:
+    void processBatch(const InBatch& inBatch, const OutBatch& outBatch) const override {
+        const auto& lhs = std::get<0>(inBatch);
+        const auto& rhs = std::get<1>(inBatch);
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            std::get<0>(outBatch)[i] = lhs[i] + rhs[i];
+            std::get<1>(outBatch)[i] = lhs[i] - rhs[i];
+        }
+        batchSizes.push_back(lhs.size());
+    }
+
+    mutable std::vector<size_t> batchSizes;
+};
+
+}
+
+TEST_CASE("Stream queue") {
+    StreamQueue<int> queue(2);
+    std::shared_ptr<const int> item;
+    REQUIRE(queue.push(std::make_shared<const int>(1)));
+    REQUIRE(queue.push(std::make_shared<const int>(2)));
+    std::shared_ptr<const int> popped;
+    std::thread consumer([&queue, &popped]{
+        queue.pop(popped);
+    });
+    // waits for the consumer to make room
+    REQUIRE(queue.push(std::make_shared<const int>(3)));
+    consumer.join();
+    REQUIRE(*popped == 1);
+    queue.close();
+    REQUIRE(queue.pop(item));
+    REQUIRE(*item == 2);
+    REQUIRE(queue.pop(item));
+    REQUIRE(*item == 3);
+    REQUIRE_FALSE(queue.pop(item));
+
+    StreamQueue<int> abandoned(1);
+    abandoned.abandon();
+    REQUIRE_FALSE(abandoned.push(std::make_shared<const int>(1)));
+    REQUIRE_THROWS_AS(StreamQueue<int>(0), PipelineException);
+}
+
+TEST_CASE("Ring buffer") {
+    RingBuffer<size_t> buffer(3);
+    size_t item = 0;
+    REQUIRE_FALSE(buffer.tryPop(item));
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(buffer.tryPush(i));
+    }
+    item = 3;
+    REQUIRE_FALSE(buffer.tryPush(item));
+    REQUIRE(buffer.tryPop(item));
+    REQUIRE(item == 0);
+    item = 3;
+    REQUIRE(buffer.tryPush(item));
+    for (size_t i = 1; i < 4; ++i) {
+        REQUIRE(buffer.tryPop(item));
+        REQUIRE(item == i);
+    }
+    REQUIRE_THROWS_AS(RingBuffer<size_t>(0), PipelineException);
+
+    // a single cell is full after one push
+    RingBuffer<size_t> single(1);
+    item = 1;
+    REQUIRE(single.tryPush(item));
+    item = 2;
+    REQUIRE_FALSE(single.tryPush(item));
+    REQUIRE(single.tryPop(item));
+    REQUIRE(item == 1);
+    REQUIRE_FALSE(single.tryPop(item));
+
+    // every item gets through exactly once with several producers and consumers
+    constexpr size_t ItemsPerProducer = 20000;
+    RingBuffer<size_t> shared(8);
+    std::atomic<size_t> popped(0);
+    std::atomic<size_t> sum(0);
+    std::vector<std::thread> threads;
+    for (size_t producer = 0; producer < 2; ++producer) {
+        threads.emplace_back([&shared, producer]{
+            for (size_t i = 0; i < ItemsPerProducer; ++i) {
+                size_t value = producer * ItemsPerProducer + i;
+                while (!shared.tryPush(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (size_t consumer = 0; consumer < 2; ++consumer) {
+        threads.emplace_back([&shared, &popped, &sum]{
+            size_t value;
+            while (popped.load() < 2 * ItemsPerProducer) {
+                if (shared.tryPop(value)) {
+                    sum += value;
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(sum == (2 * ItemsPerProducer - 1) * 2 * ItemsPerProducer / 2);
+}
+
+TEST_CASE("Stream queue backpressure") {
+    std::shared_ptr<const int> item;
+    StreamQueue<int> dropOldest(2, Backpressure::DropOldest);
+    StreamQueue<int> dropNewest(2, Backpressure::DropNewest);
+    for (int i = 0; i < 5; ++i) {
+        REQUIRE(dropOldest.push(std::make_shared<const int>(i)));
+        REQUIRE(dropNewest.push(std::make_shared<const int>(i)));
+    }
+    REQUIRE(dropOldest.getDroppedCount() == 3);
+    REQUIRE(dropNewest.getDroppedCount() == 3);
+    dropOldest.close();
+    dropNewest.close();
+    for (int expected : { 3, 4 }) {
+        REQUIRE(dropOldest.pop(item));
+        REQUIRE(*item == expected);
+    }
+    for (int expected : { 0, 1 }) {
+        REQUIRE(dropNewest.pop(item));
+        REQUIRE(*item == expected);
+    }
+    REQUIRE_FALSE(dropOldest.pop(item));
+    REQUIRE_FALSE(dropNewest.pop(item));
+}
+
+TEST_CASE("Streaming edge options") {
+    StreamSource<int> source(64);
+    SlowNode slow;
+    slow.connect(source, 0, 0, EdgeOptions{ 1, Backpressure::DropOldest });
+    REQUIRE(slow.getEdgeOptions(0).backpressure == Backpressure::DropOldest);
+    for (int i = 0; i < 50; ++i) {
+        source.push(i);
+    }
+    source.close();
+
+    // the slow stage only sees the latest items, without holding up its producer
+    StreamExecution stream(&slow);
+    std::shared_ptr<const int> item;
+    int count = 0;
+    int last = -1;
+    while (stream.pop(item)) {
+        REQUIRE(*item > last);
+        last = *item;
+        ++count;
+    }
+    stream.wait();
+    REQUIRE(last == 49);
+    REQUIRE(count < 50);
+
+    // connecting again restores the default options
+    slow.connect(source, 0, 0);
+    REQUIRE(slow.getEdgeOptions(0).capacity == 0);
+    REQUIRE(slow.getEdgeOptions(0).backpressure == Backpressure::Block);
+
+    // and so does disconnecting
+    slow.connect(source, 0, 0, EdgeOptions{ 2, Backpressure::DropNewest });
+    slow.disconnect(0);
+    REQUIRE(slow.getEdgeOptions(0).capacity == 0);
+    REQUIRE(slow.getEdgeOptions(0).backpressure == Backpressure::Block);
+
+    // items of several inputs are paired in order, none of them can be dropped
+    SubtractNode subtract;
+    REQUIRE_THROWS_AS(subtract.connect(source, 0, 0, EdgeOptions{ 2, Backpressure::DropOldest }), PipelineException);
+    REQUIRE_FALSE(subtract.isConnected());
+    subtract.connect(source, 0, 0, EdgeOptions{ 2, Backpressure::Block });
+    REQUIRE(subtract.getEdgeOptions(0).capacity == 2);
+}
+
+TEST_CASE("Streaming execution") {
+    StreamSource<int> source(4);
+    SquareNode square;
+    SubtractNode subtract;
+    square.connect(source, 0, 0);
+    subtract.connect(square, 0, 0);
+    subtract.connect(source, 1, 0);
+
+    for (int round = 0; round < 2; ++round) {
+        StreamExecution stream(&subtract, 2);
+        std::thread producer([&source]{
+            for (int i = 0; i < 100; ++i) {
+                source.push(i);
+            }
+            source.close();
+        });
+        std::shared_ptr<const int> item;
+        int count = 0;
+        while (stream.pop(item)) {
+            REQUIRE(*item == count * count - count);
+            ++count;
+        }
+        producer.join();
+        REQUIRE(count == 100);
+        stream.wait();
+    }
+    // the nodes' own outputs are not touched by a stream
+    REQUIRE_FALSE(subtract.isDataValid());
+    REQUIRE_FALSE(subtract.getOutConn(0)->isDataAvailable());
+}
+
+TEST_CASE("Streaming stages overlap") {
+    StreamSource<int> source(32);
+    std::atomic<int> running(0);
+    std::atomic<int> mostRunning(0);
+    std::vector<std::unique_ptr<OverlapNode>> stages;
+    NodeBase* last = &source;
+    for (int i = 0; i < 4; ++i) {
+        stages.push_back(std::make_unique<OverlapNode>(running, mostRunning));
+        stages.back()->connect(*last, 0, 0);
+        last = stages.back().get();
+    }
+    for (int i = 0; i < 20; ++i) {
+        source.push(i);
+    }
+    source.close();
+    StreamExecution stream(last, 4);
+    std::shared_ptr<const int> item;
+    int expected = 0;
+    while (stream.pop(item)) {
+        REQUIRE(*item == expected++);
+    }
+    stream.wait();
+    REQUIRE(expected == 20);
+    // each stage works on its next item while the later stages handle the earlier ones
+    REQUIRE(mostRunning > 1);
+    REQUIRE(running == 0);
+}
+
+TEST_CASE("Streaming forwards shared items") {
+    StreamSource<std::vector<int>> source;
+    ForwardNode forward;
+    forward.connect(source, 0, 0);
+    auto data = std::make_shared<const std::vector<int>>(1000, 7);
+    source.push(data);
+    source.close();
+    StreamExecution stream(&forward);
+    std::shared_ptr<const std::vector<int>> item;
+    REQUIRE(stream.pop(item));
+    REQUIRE(item == data);
+    REQUIRE_FALSE(stream.pop(item));
+    REQUIRE_THROWS_AS(stream.pop(item, 1), PipelineException);
+    std::shared_ptr<const int> wrongType;
+    REQUIRE_THROWS_AS(stream.pop(wrongType), PipelineException);
+    stream.wait();
+}
+
+TEST_CASE("Streaming batches") {
+    StreamSource<int> source(256);
+    SquareNode square;
+    BatchAddNode add;
+    square.connect(source, 0, 0);
+    add.connect(square, 0, 0);
+    add.connect(source, 1, 0);
+    add.setBatchSize(8);
+    REQUIRE_THROWS_AS(add.setBatchSize(0), PipelineException);
+
+    for (int i = 0; i < 200; ++i) {
+        source.push(i);
+    }
+    source.close();
+    StreamExecution stream(&add, 64);
+    std::shared_ptr<const int> sum;
+    std::shared_ptr<const int> difference;
+    int count = 0;
+    while (stream.pop(sum, 0) && stream.pop(difference, 1)) {
+        REQUIRE(*sum == count * count + count);
+        REQUIRE(*difference == count * count - count);
+        ++count;
+    }
+    stream.wait();
+    REQUIRE(count == 200);
+    size_t batched = 0;
+    for (size_t size : add.batchSizes) {
+        REQUIRE(size >= 1);
+        REQUIRE(size <= 8);
+        batched += size;
+    }
+    REQUIRE(batched == 200);
+
+    // a single value is a batch of one
+    ConstantNode constant;
+    BatchAddNode single;
+    single.connect(constant, 0, 0);
+    single.connect(constant, 1, 0);
+    constant.evaluate();
+    single.evaluate();
+    REQUIRE(dynamic_cast<const OutConn<int>*>(single.getOutConn(0))->getData() == 2);
+    REQUIRE(dynamic_cast<const OutConn<int>*>(single.getOutConn(1))->getData() == 0);
+    REQUIRE(single.batchSizes == std::vector<size_t>{ 1 });
+}
+
+TEST_CASE("Streaming batches of inputs ending apart") {
+    // an item is only taken once every input has one
+    StreamInputs<std::tuple<int, int>> inputs({ {} }, 4);
+    auto& left = static_cast<StreamQueue<int>&>(inputs.getQueue(0));
+    auto& right = static_cast<StreamQueue<int>&>(inputs.getQueue(1));
+    StreamInputs<std::tuple<int, int>>::Items items;
+    left.push(std::make_shared<const int>(1));
+    REQUIRE_FALSE(inputs.tryPop(items));
+    right.push(std::make_shared<const int>(2));
+    REQUIRE(inputs.tryPop(items));
+    REQUIRE(*std::get<0>(items) == 1);
+    REQUIRE(*std::get<1>(items) == 2);
+
+    StreamSource<int> longer(64);
+    StreamSource<int> shorter(64);
+    BatchAddNode add;
+    add.connect(longer, 0, 0);
+    add.connect(shorter, 1, 0);
+    for (int i = 0; i < 20; ++i) {
+        longer.push(i * 10);
+        if (i < 12) {
+            shorter.push(i);
+        }
+    }
+    longer.close();
+    shorter.close();
+    StreamExecution stream(&add, 64);
+    std::shared_ptr<const int> sum;
+    std::shared_ptr<const int> difference;
+    int count = 0;
+    while (stream.pop(sum, 0) && stream.pop(difference, 1)) {
+        REQUIRE(*sum == count * 11);
+        REQUIRE(*difference == count * 9);
+        ++count;
+    }
+    stream.wait();
+    REQUIRE(count == 12);
+}
+
+TEST_CASE("Streaming errors") {
+    StreamSource<int> source(1);
+    FailingNode failing;
+    SquareNode square;
+    failing.connect(source, 0, 0);
+    square.connect(failing, 0, 0);
+
+    SECTION("An exception stops the stream") {
+        StreamExecution stream(&square, 1);
+        std::thread producer([&source]{
+            // pushing fails once the stream stopped
+            int i = 0;
+            while (source.push(i++)) {
+            }
+        });
+        std::shared_ptr<const int> item;
+        int count = 0;
+        while (stream.pop(item)) {
+            ++count;
+        }
+        producer.join();
+        REQUIRE(count <= 3);
+        REQUIRE_THROWS_AS(stream.wait(), PipelineException);
+    }
+
+    SECTION("Stopping a stream") {
+        StreamExecution stream(&square, 1);
+        source.push(1);
+        std::shared_ptr<const int> item;
+        REQUIRE(stream.pop(item));
+        REQUIRE(*item == 1);
+        stream.stop();
+        REQUIRE_FALSE(stream.pop(item));
+        stream.wait();
+    }
+
+    SECTION("Sources have to be stream sources") {
+        SquareNode unconnected;
+        REQUIRE_THROWS_AS(StreamExecution(&unconnected), PipelineException);
+        ConstantNode constant;
+        unconnected.connect(constant, 0, 0);
+        StreamExecution stream(&unconnected);
+        REQUIRE_THROWS_AS(stream.wait(), PipelineException);
+    }
+}
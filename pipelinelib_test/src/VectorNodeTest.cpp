@@ -0,0 +1,147 @@
+#include <vector>
+#include <cstdint>
+#include "catch.hpp"
+#include "ConstNode.hpp"
+#include "VectorNodes.hpp"
+#include "StreamSource.hpp"
+#include "StreamExecution.hpp"
+
+using namespace mfep::Pipeline;
+
+namespace {
+
+template<typename T>
+const T& getOutput(const NodeBase& node, size_t index = 0) {
+    return dynamic_cast<const OutConn<T>*>(node.getOutConn(index))->getData();
+}
+
+}
+
+TEST_CASE("Aligned columns") {
+    for (size_t size : { 1, 3, 100 }) {
+        Column<float> column(size, 1.f);
+        REQUIRE(reinterpret_cast<uintptr_t>(column.data()) % 64 == 0);
+        column.resize(size * 7);
+        REQUIRE(reinterpret_cast<uintptr_t>(column.data()) % 64 == 0);
+    }
+}
+
+TEST_CASE("Vector kernels") {
+    const SimdLevel supported = getSupportedSimdLevel();
+    REQUIRE(getSimdLevel() == supported);
+    if (supported != SimdLevel::Avx512) {
+        REQUIRE_THROWS_AS(setSimdLevel(SimdLevel::Avx512), PipelineException);
+    }
+
+    // every level gets the same results, including the items left over after the full vectors
+    for (int level = 0; level <= static_cast<int>(supported); ++level) {
+        setSimdLevel(static_cast<SimdLevel>(level));
+        for (size_t size : { 0, 1, 7, 8, 17, 100 }) {
+            std::vector<int32_t> ints(size);
+            std::vector<float> floats(size);
+            for (size_t i = 0; i < size; ++i) {
+                ints[i] = static_cast<int32_t>(i * 37 % 101) - 50;
+                floats[i] = static_cast<float>(ints[i]) / 4;
+            }
+            std::vector<int32_t> intOut(size);
+            std::vector<float> floatOut(size);
+            vectorAdd(ints.data(), ints.data(), intOut.data(), size);
+            for (size_t i = 0; i < size; ++i) {
+                REQUIRE(intOut[i] == ints[i] * 2);
+            }
+            vectorMultiply(ints.data(), ints.data(), intOut.data(), size);
+            for (size_t i = 0; i < size; ++i) {
+                REQUIRE(intOut[i] == ints[i] * ints[i]);
+            }
+            vectorAdd(floats.data(), floats.data(), floatOut.data(), size);
+            for (size_t i = 0; i < size; ++i) {
+                REQUIRE(floatOut[i] == floats[i] * 2);
+            }
+            vectorMultiply(floats.data(), floats.data(), floatOut.data(), size);
+            for (size_t i = 0; i < size; ++i) {
+                REQUIRE(floatOut[i] == floats[i] * floats[i]);
+            }
+            vectorConvert(ints.data(), floatOut.data(), size);
+            int32_t intSum = 0;
+            float floatSum = 0;
+            for (size_t i = 0; i < size; ++i) {
+                REQUIRE(floatOut[i] == static_cast<float>(ints[i]));
+                intSum += ints[i];
+                floatSum += floats[i];
+            }
+            // quarters add up exactly in any order
+            REQUIRE(vectorSum(ints.data(), size) == intSum);
+            REQUIRE(vectorSum(floats.data(), size) == floatSum);
+        }
+        // integers wrap around
+        const int32_t large[] = { INT32_MAX, INT32_MAX };
+        int32_t wrapped[2];
+        vectorAdd(large, large, wrapped, 2);
+        REQUIRE(wrapped[0] == -2);
+    }
+    setSimdLevel(supported);
+}
+
+TEST_CASE("Column nodes") {
+    ConstNode<Column<int>> lhs(Column<int>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 });
+    ConstNode<Column<int>> rhs(Column<int>{ 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 });
+    ColumnAddNode<int> add;
+    ColumnMultiplyNode<int> multiply;
+    ColumnConvertNode<int, float> convert;
+    ColumnSumNode<float> sum;
+    add.connect(lhs, 0, 0);
+    add.connect(rhs, 1, 0);
+    multiply.connect(add, 0, 0);
+    multiply.connect(lhs, 1, 0);
+    convert.connect(multiply, 0, 0);
+    sum.connect(convert, 0, 0);
+
+    lhs.evaluate();
+    rhs.evaluate();
+    add.evaluate();
+    multiply.evaluate();
+    convert.evaluate();
+    sum.evaluate();
+    REQUIRE(getOutput<Column<int>>(add) == Column<int>(10, 11));
+    REQUIRE(getOutput<Column<float>>(convert)[9] == 110.f);
+    REQUIRE(getOutput<float>(sum) == 605.f);
+
+    ConstNode<Column<int>> shorter(Column<int>{ 1 });
+    add.connect(shorter, 1, 0);
+    shorter.evaluate();
+    REQUIRE_THROWS_AS(add.evaluate(), PipelineException);
+}
+
+TEST_CASE("Vector nodes in a stream") {
+    StreamSource<int> source(128);
+    VectorMultiplyNode<int> square;
+    VectorAddNode<int> add;
+    VectorConvertNode<int, float> convert;
+    square.connect(source, 0, 0);
+    square.connect(source, 1, 0);
+    add.connect(square, 0, 0);
+    add.connect(source, 1, 0);
+    convert.connect(add, 0, 0);
+
+    for (int i = 0; i < 100; ++i) {
+        source.push(i);
+    }
+    source.close();
+    StreamExecution stream(&convert, 32);
+    std::shared_ptr<const float> item;
+    int count = 0;
+    while (stream.pop(item)) {
+        REQUIRE(*item == static_cast<float>(count * count + count));
+        ++count;
+    }
+    stream.wait();
+    REQUIRE(count == 100);
+
+    // a single value is a batch of one
+    ConstNode<int> constant(3);
+    add.connect(constant, 0, 0);
+    add.connect(constant, 1, 0);
+    constant.evaluate();
+    add.evaluate();
+    REQUIRE(getOutput<int>(add) == 6);
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "catch.hpp"
+#include "WorkStealingDeque.hpp"
+#include "WorkStealingPool.hpp"
+#include "PipelineException.hpp"
+
+using namespace mfep::Pipeline;
+
+TEST_CASE("Work stealing deque") {
+    WorkStealingDeque<size_t> deque(2);
+    size_t item;
+    REQUIRE(deque.empty());
+    REQUIRE_FALSE(deque.pop(item));
+    REQUIRE_FALSE(deque.steal(item));
+
+    // pop takes the newest item, steal the oldest, growing keeps the order
+    for (size_t i = 0; i < 10; ++i) {
+        deque.push(i);
+    }
+    REQUIRE(deque.pop(item));
+    REQUIRE(item == 9);
+    REQUIRE(deque.steal(item));
+    REQUIRE(item == 0);
+    size_t count = 0;
+    while (deque.pop(item)) {
+        ++count;
+    }
+    REQUIRE(count == 8);
+    REQUIRE(deque.empty());
+}
+TEST_CASE("Concurrent stealing") {
+    const size_t n = 100000;
+    WorkStealingDeque<size_t> deque;
+    std::atomic<bool> done { false };
+    std::vector<std::vector<size_t>> stolen(3);
+    std::vector<std::thread> thieves;
+    for (auto& items : stolen) {
+        thieves.emplace_back([&deque, &done, &items]{
+            size_t item;
+            while (!done.load()) {
+                if (deque.steal(item)) {
+                    items.push_back(item);
+                }
+            }
+        });
+    }
+    std::vector<size_t> popped;
+    for (size_t i = 0; i < n; ++i) {
+        deque.push(i);
+        size_t item;
+        if (i % 3 == 0 && deque.pop(item)) {
+            popped.push_back(item);
+        }
+    }
+    size_t item;
+    while (deque.pop(item)) {
+        popped.push_back(item);
+    }
+    done = true;
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    // every item is taken exactly once
+    std::vector<size_t> seen(n, 0);
+    for (size_t i : popped) {
+        ++seen[i];
+    }
+    for (const auto& items : stolen) {
+        for (size_t i : items) {
+            ++seen[i];
+        }
+    }
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](size_t count){ return count == 1; }));
+}
+TEST_CASE("Work stealing pool") {
+    WorkStealingPool pool(4);
+    REQUIRE(pool.getThreadCount() == 4);
+    REQUIRE_THROWS_AS(WorkStealingPool(0), PipelineException);
+
+    // every task spawns two children until the depth runs out: a full binary tree of tasks
+    const size_t depth = 14;
+    std::vector<std::atomic<size_t>> runs(depth + 1);
+    const WorkStealingPool::TaskRunner runner = [&pool, &runs, depth](size_t task, size_t worker) {
+        ++runs[task];
+        if (task < depth) {
+            pool.spawn(worker, task + 1);
+            pool.spawn(worker, task + 1);
+        }
+    };
+    for (size_t i = 0; i < 3; ++i) {
+        for (auto& count : runs) {
+            count = 0;
+        }
+        pool.run(runner, { 0 });
+        for (size_t level = 0; level <= depth; ++level) {
+            REQUIRE(runs[level] == size_t(1) << level);
+        }
+    }
+    pool.run(runner, {});
+}